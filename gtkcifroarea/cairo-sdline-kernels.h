@@ -0,0 +1,199 @@
+/*
+ * GtkCifroArea - 2D layers image management library.
+ *
+ * Copyright 2013-2016 Andrei Fadeev (andrei@webcontrol.ru)
+ *
+ * This file is part of GtkCifroArea.
+ *
+ * GtkCifroArea is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GtkCifroArea is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the author in this case.
+ *
+ */
+
+/*
+ * \file cairo-sdline-kernels.h
+ *
+ * \brief Шаблон функций рисования для одного формата точек поверхности
+ * \author Andrei Fadeev
+ * \date 2013-2016
+ * \license GNU General Public License version 3 или более поздняя<br>
+ * Коммерческая лицензия - свяжитесь с автором
+ *
+ * Файл включается в cairo-sdline.c один раз для каждого формата точек. Перед
+ * включением должны быть определены макросы:
+ *
+ * - SDLINE_FORMAT - суффикс имён функций формата;
+ * - SDLINE_TYPE - тип точки поверхности.
+ *
+ * А также функции _unpack<SDLINE_FORMAT> и _pack<SDLINE_FORMAT> перевода точки
+ * в 32-х битный цвет ARGB с умноженными на альфа составляющими и обратно.
+ * Смешивание цветов выполняется в формате ARGB, поэтому все форматы используют
+ * одни и те же функции смешивания.
+ *
+ */
+
+#define _SDLINE_NAME2(name, format)    name##format
+#define _SDLINE_NAME1(name, format)    _SDLINE_NAME2 (name, format)
+#define SDLINE_KERNEL(name)            _SDLINE_NAME1 (name, SDLINE_FORMAT)
+
+#define UNPACK                         SDLINE_KERNEL (_unpack)
+#define PACK                           SDLINE_KERNEL (_pack)
+
+/* Функция переводит цвет в формат точек поверхности. */
+static guint32
+SDLINE_KERNEL (_native) (guint32 color)
+{
+  return PACK (color);
+}
+
+/* Функция смешивает цвет с точкой. */
+static inline void
+SDLINE_KERNEL (_blendPixel) (const _sdlineBlender *blender,
+                             guchar               *pixel)
+{
+  SDLINE_TYPE *dst = (SDLINE_TYPE*) pixel;
+
+  switch (blender->blend)
+    {
+    case CAIRO_SDLINE_BLEND_OVER:
+      *dst = PACK (blender->color + _mulAlpha (UNPACK (*dst), blender->inv_alpha));
+      break;
+
+    case CAIRO_SDLINE_BLEND_ADD:
+      *dst = PACK (_addSaturate (UNPACK (*dst), blender->color));
+      break;
+
+    case CAIRO_SDLINE_BLEND_MAX:
+      *dst = PACK (_maxComponents (UNPACK (*dst), blender->color));
+      break;
+
+    default:
+      *dst = blender->native;
+      break;
+    }
+}
+
+/* Функция смешивает цвет с непрерывным отрезком из count точек. Выбор режима
+   вынесен из внутренних циклов, чтобы компилятор мог их векторизовать. */
+static void
+SDLINE_KERNEL (_blendSpan) (const _sdlineBlender *blender,
+                            guchar               *pixels,
+                            gint32                count)
+{
+  SDLINE_TYPE *dst = (SDLINE_TYPE*) pixels;
+  SDLINE_TYPE native = blender->native;
+  guint32 color = blender->color;
+  guint32 inv_alpha = blender->inv_alpha;
+  gint32 i;
+
+  switch (blender->blend)
+    {
+    case CAIRO_SDLINE_BLEND_OVER:
+      for (i = 0; i < count; i++)
+        dst[i] = PACK (color + _mulAlpha (UNPACK (dst[i]), inv_alpha));
+      break;
+
+    case CAIRO_SDLINE_BLEND_ADD:
+      for (i = 0; i < count; i++)
+        dst[i] = PACK (_addSaturate (UNPACK (dst[i]), color));
+      break;
+
+    case CAIRO_SDLINE_BLEND_MAX:
+      for (i = 0; i < count; i++)
+        dst[i] = PACK (_maxComponents (UNPACK (dst[i]), color));
+      break;
+
+    default:
+      for (i = 0; i < count; i++)
+        dst[i] = native;
+      break;
+    }
+}
+
+/* Функция рисует линию по алгоритму Брезенхэма. Линия проходит dx точек с шагом
+   pixx байт, через каждые dx / dy точек делается дополнительный шаг pixy байт. */
+static void
+SDLINE_KERNEL (_blendLine) (const _sdlineBlender *blender,
+                            guchar               *pixel,
+                            gint32                pixx,
+                            gint32                pixy,
+                            gint32                dx,
+                            gint32                dy)
+{
+  gint32 x, y;
+
+  for (x = 0, y = 0; x < dx; x++, pixel += pixx)
+    {
+      SDLINE_KERNEL (_blendPixel) (blender, pixel);
+      y += dy;
+      if (y >= dx)
+        {
+          y -= dx;
+          pixel += pixy;
+        }
+    }
+}
+
+/* Функция смешивает цвет сглаженной линии с точкой с учётом покрытия точки
+   линией coverage (от 0 до 256). В режимах замены и наложения цвета смешиваются
+   в линейном пространстве, что точно для непрозрачного фона. */
+static void
+SDLINE_KERNEL (_blendPixelAA) (const _sdlineAABlender *blender,
+                               guchar                 *pixel,
+                               guint32                 coverage)
+{
+  SDLINE_TYPE *dst = (SDLINE_TYPE*) pixel;
+  guint32 color = UNPACK (*dst);
+  guint32 weight;
+
+  switch (blender->blend)
+    {
+    case CAIRO_SDLINE_BLEND_ADD:
+      *dst = PACK (_addSaturate (color, _mulAlpha (blender->color, coverage - (coverage >> 8))));
+      break;
+
+    case CAIRO_SDLINE_BLEND_MAX:
+      *dst = PACK (_maxComponents (color, _mulAlpha (blender->color, coverage - (coverage >> 8))));
+      break;
+
+    default:
+      weight = (blender->alpha * coverage) >> 8;
+      *dst = PACK (((((color >> 24) * (256 - weight) + 255 * weight) >> 8) << 24) |
+                   (_fromLinear[(blender->linear[2] * weight + _toLinear[(color >> 16) & 0xFF] * (256 - weight)) >> 8] << 16) |
+                   (_fromLinear[(blender->linear[1] * weight + _toLinear[(color >> 8) & 0xFF] * (256 - weight)) >> 8] << 8) |
+                   (_fromLinear[(blender->linear[0] * weight + _toLinear[color & 0xFF] * (256 - weight)) >> 8]));
+      break;
+    }
+}
+
+/* Функции рисования формата. */
+static const _sdlineKernels SDLINE_KERNEL (_kernels) =
+{
+  sizeof (SDLINE_TYPE),
+  SDLINE_KERNEL (_native),
+  SDLINE_KERNEL (_blendPixel),
+  SDLINE_KERNEL (_blendSpan),
+  SDLINE_KERNEL (_blendLine),
+  SDLINE_KERNEL (_blendPixelAA)
+};
+
+#undef UNPACK
+#undef PACK
+#undef SDLINE_KERNEL
+#undef _SDLINE_NAME1
+#undef _SDLINE_NAME2
+#undef SDLINE_FORMAT
+#undef SDLINE_TYPE
@@ -38,6 +38,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 /*
  * Clipping routines for line.
@@ -45,7 +46,7 @@
  * Clipping based heavily on code from http://www.ncsa.uiuc.edu/Vis/Graphics/src/clipCohSuth.c
  *
  */
-#define PIXEL_SIZE             4
+#define PIXEL(surface, x, y)   ((guchar*)(surface)->data + ((y) * (surface)->stride) + ((x) * (surface)->pixel_size))
 
 #define CLIP_LEFT_EDGE         0x1
 #define CLIP_RIGHT_EDGE        0x2
@@ -219,6 +220,472 @@ _clipLine (cairo_sdline_surface *surface,
   return draw;
 }
 
+/* Функция умножает все четыре составляющие цвета на alpha / 255,
+   по две составляющие за одно умножение. */
+static inline guint32
+_mulAlpha (guint32 color,
+           guint32 alpha)
+{
+  guint32 rb = (color & 0x00FF00FF) * alpha + 0x00800080;
+  guint32 ag = ((color >> 8) & 0x00FF00FF) * alpha + 0x00800080;
+
+  rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+  ag = (ag + ((ag >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+
+  return rb | ag;
+}
+
+/* Функция складывает составляющие цветов с насыщением, по две составляющие за одно сложение. */
+static inline guint32
+_addSaturate (guint32 color1,
+              guint32 color2)
+{
+  guint32 rb = (color1 & 0x00FF00FF) + (color2 & 0x00FF00FF);
+  guint32 ag = ((color1 >> 8) & 0x00FF00FF) + ((color2 >> 8) & 0x00FF00FF);
+
+  rb |= 0x01000100 - ((rb >> 8) & 0x00010001);
+  ag |= 0x01000100 - ((ag >> 8) & 0x00010001);
+
+  return (rb & 0x00FF00FF) | ((ag & 0x00FF00FF) << 8);
+}
+
+/* Функция выбирает максимальные значения составляющих цветов. */
+static inline guint32
+_maxComponents (guint32 color1,
+                guint32 color2)
+{
+  return MAX (color1 & 0xFF000000, color2 & 0xFF000000) |
+         MAX (color1 & 0x00FF0000, color2 & 0x00FF0000) |
+         MAX (color1 & 0x0000FF00, color2 & 0x0000FF00) |
+         MAX (color1 & 0x000000FF, color2 & 0x000000FF);
+}
+
+typedef struct _sdlineKernels _sdlineKernels;
+
+/* Функция проверяет, находится ли точка внутри области рисования. */
+static inline gboolean
+_clipContains (cairo_sdline_surface *surface,
+               gint32                x,
+               gint32                y)
+{
+  return ((guint32) (x - surface->clip_left) < (guint32) (surface->clip_right - surface->clip_left)) &&
+         ((guint32) (y - surface->clip_top) < (guint32) (surface->clip_bottom - surface->clip_top));
+}
+
+/* Параметры смешивания цвета с пикселями поверхности. */
+typedef struct
+{
+  const _sdlineKernels *kernels;               /* Функции рисования для формата точек поверхности. */
+  cairo_sdline_blend   blend;                  /* Режим смешивания. */
+  guint32              color;                  /* Цвет, для режимов смешивания - с умноженными на альфа составляющими. */
+  guint32              native;                 /* Цвет в формате точек поверхности для режима замены. */
+  guint32              inv_alpha;              /* Дополнение альфа канала цвета до 255. */
+  guint64             *n_pixels;               /* Счётчик изменённых пикселей поверхности. */
+} _sdlineBlender;
+
+/* Параметры смешивания цвета сглаженной линии. */
+typedef struct
+{
+  const _sdlineKernels *kernels;               /* Функции рисования для формата точек поверхности. */
+  cairo_sdline_blend   blend;                  /* Режим смешивания. */
+  guint32              color;                  /* Цвет с умноженными на альфа составляющими. */
+  guint32              alpha;                  /* Альфа канал цвета от 0 до 256. */
+  guint32              linear[3];              /* Составляющие цвета в линейном пространстве. */
+} _sdlineAABlender;
+
+/* Функции рисования для одного формата точек поверхности. */
+struct _sdlineKernels
+{
+  gint                 pixel_size;             /* Размер точки в байтах. */
+
+  guint32            (*native)                 (guint32                 color);
+
+  void               (*pixel)                  (const _sdlineBlender   *blender,
+                                                guchar                 *pixel);
+
+  void               (*span)                   (const _sdlineBlender   *blender,
+                                                guchar                 *pixels,
+                                                gint32                  count);
+
+  void               (*line)                   (const _sdlineBlender   *blender,
+                                                guchar                 *pixel,
+                                                gint32                  pixx,
+                                                gint32                  pixy,
+                                                gint32                  dx,
+                                                gint32                  dy);
+
+  void               (*pixel_aa)               (const _sdlineAABlender *blender,
+                                                guchar                 *pixel,
+                                                guint32                 coverage);
+};
+
+/* Число значений составляющей цвета в линейном пространстве. */
+#define LINEAR_SIZE            4096
+
+/* Таблицы перевода составляющих цвета из sRGB в линейное пространство и обратно. */
+static guint16 _toLinear[256];
+static guint8 _fromLinear[LINEAR_SIZE];
+
+/* Функция заполняет таблицы перевода составляющих цвета при первом вызове. */
+static void
+_gammaInit (void)
+{
+  static gsize initialized = 0;
+  gint i;
+
+  if (!g_once_init_enter (&initialized))
+    return;
+
+  for (i = 0; i < 256; i++)
+    _toLinear[i] = pow (i / 255.0, 2.2) * (LINEAR_SIZE - 1) + 0.5;
+
+  for (i = 0; i < LINEAR_SIZE; i++)
+    _fromLinear[i] = pow ((gdouble) i / (LINEAR_SIZE - 1), 1.0 / 2.2) * 255.0 + 0.5;
+
+  g_once_init_leave (&initialized, 1);
+}
+
+/* Точки форматов ARGB32 и RGB24 хранятся как есть. */
+static inline guint32
+_unpackARGB32 (guint32 pixel)
+{
+  return pixel;
+}
+
+static inline guint32
+_packARGB32 (guint32 color)
+{
+  return color;
+}
+
+/* Точки формата RGB16_565 расширяются до 8 бит на составляющую, альфа канал непрозрачный. */
+static inline guint32
+_unpackRGB16 (guint16 pixel)
+{
+  guint32 red = (pixel >> 11) & 0x1F;
+  guint32 green = (pixel >> 5) & 0x3F;
+  guint32 blue = pixel & 0x1F;
+
+  return 0xFF000000 |
+         (((red << 3) | (red >> 2)) << 16) |
+         (((green << 2) | (green >> 4)) << 8) |
+         ((blue << 3) | (blue >> 2));
+}
+
+static inline guint16
+_packRGB16 (guint32 color)
+{
+  return ((color >> 8) & 0xF800) | ((color >> 5) & 0x07E0) | ((color >> 3) & 0x001F);
+}
+
+/* Точки формата A8 хранят только альфа канал. */
+static inline guint32
+_unpackA8 (guint8 pixel)
+{
+  return (guint32) pixel << 24;
+}
+
+static inline guint8
+_packA8 (guint32 color)
+{
+  return color >> 24;
+}
+
+#define SDLINE_FORMAT          ARGB32
+#define SDLINE_TYPE            guint32
+#include "cairo-sdline-kernels.h"
+
+#define SDLINE_FORMAT          RGB16
+#define SDLINE_TYPE            guint16
+#include "cairo-sdline-kernels.h"
+
+#define SDLINE_FORMAT          A8
+#define SDLINE_TYPE            guint8
+#include "cairo-sdline-kernels.h"
+
+/* Функция возвращает функции рисования для формата точек поверхности. */
+static inline const _sdlineKernels *
+_surfaceKernels (cairo_format_t format)
+{
+  switch (format)
+    {
+    case CAIRO_FORMAT_RGB16_565:
+      return &_kernelsRGB16;
+
+    case CAIRO_FORMAT_A8:
+      return &_kernelsA8;
+
+    default:
+      return &_kernelsARGB32;
+    }
+}
+
+/* Функция подготавливает параметры смешивания цвета для поверхности. */
+static inline void
+_blendPrepare (cairo_sdline_surface *surface,
+               guint32               color,
+               _sdlineBlender       *blender)
+{
+  guint32 alpha = color >> 24;
+
+  blender->kernels = _surfaceKernels (surface->format);
+  blender->blend = surface->blend;
+  blender->color = color;
+  blender->native = blender->kernels->native (color);
+  blender->inv_alpha = 255 - alpha;
+  blender->n_pixels = &surface->n_pixels;
+
+  if (blender->blend == CAIRO_SDLINE_BLEND_COPY)
+    return;
+
+  /* Поверхности cairo хранят цвета с умноженными на альфа составляющими. */
+  blender->color = (alpha << 24) | (_mulAlpha (color, alpha) & 0x00FFFFFF);
+
+  /* Непрозрачный цвет при наложении просто заменяет пиксели. */
+  if ((blender->blend == CAIRO_SDLINE_BLEND_OVER) && (alpha == 0xFF))
+    blender->blend = CAIRO_SDLINE_BLEND_COPY;
+}
+
+/* Функция смешивает цвет с пикселем. */
+static inline void
+_blendPixel (const _sdlineBlender *blender,
+             guchar               *pixel)
+{
+  blender->kernels->pixel (blender, pixel);
+  *blender->n_pixels += 1;
+}
+
+/* Функция смешивает цвет с непрерывным отрезком из count пикселей. */
+static inline void
+_blendSpan (const _sdlineBlender *blender,
+            guchar               *pixels,
+            gint32                count)
+{
+  blender->kernels->span (blender, pixels, count);
+  *blender->n_pixels += count;
+}
+
+/* Функция подготавливает параметры смешивания цвета сглаженной линии. */
+static void
+_blendPrepareAA (cairo_sdline_surface *surface,
+                 guint32               color,
+                 _sdlineAABlender     *blender)
+{
+  guint32 alpha = color >> 24;
+
+  _gammaInit ();
+
+  blender->kernels = _surfaceKernels (surface->format);
+  blender->blend = surface->blend;
+  blender->color = (alpha << 24) | (_mulAlpha (color, alpha) & 0x00FFFFFF);
+  blender->alpha = alpha + (alpha >> 7);
+  blender->linear[0] = _toLinear[color & 0xFF];
+  blender->linear[1] = _toLinear[(color >> 8) & 0xFF];
+  blender->linear[2] = _toLinear[(color >> 16) & 0xFF];
+}
+
+/* Функция смешивает цвет сглаженной линии с пикселем с учётом покрытия пикселя
+   линией coverage (от 0 до 256), пиксели за пределами области рисования пропускаются. */
+static inline void
+_blendPixelAA (cairo_sdline_surface   *surface,
+               const _sdlineAABlender *blender,
+               gint32                  x,
+               gint32                  y,
+               guint32                 coverage)
+{
+  if (!_clipContains (surface, x, y))
+    return;
+
+  blender->kernels->pixel_aa (blender, PIXEL (surface, x, y), coverage);
+  surface->n_pixels += 1;
+}
+
+/* Функция отсекает отрезок прямоугольником (алгоритм Лианга-Барски).
+   Возвращает FALSE, если отрезок целиком лежит за пределами прямоугольника. */
+static gboolean
+_clipLineAA (gdouble  left,
+             gdouble  top,
+             gdouble  right,
+             gdouble  bottom,
+             gdouble *x1,
+             gdouble *y1,
+             gdouble *x2,
+             gdouble *y2)
+{
+  gdouble dx = *x2 - *x1;
+  gdouble dy = *y2 - *y1;
+  gdouble p[4] = { -dx, dx, -dy, dy };
+  gdouble q[4] = { *x1 - left, right - *x1, *y1 - top, bottom - *y1 };
+  gdouble t1 = 0.0;
+  gdouble t2 = 1.0;
+  gdouble r;
+  gint i;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (p[i] == 0.0)
+        {
+          if (q[i] < 0.0)
+            return FALSE;
+          continue;
+        }
+
+      r = q[i] / p[i];
+      if (p[i] < 0.0)
+        {
+          if (r > t2)
+            return FALSE;
+          if (r > t1)
+            t1 = r;
+        }
+      else
+        {
+          if (r < t1)
+            return FALSE;
+          if (r < t2)
+            t2 = r;
+        }
+    }
+
+  *x2 = *x1 + t2 * dx;
+  *y2 = *y1 + t2 * dy;
+  *x1 = *x1 + t1 * dx;
+  *y1 = *y1 + t1 * dy;
+
+  return TRUE;
+}
+
+/* Функция ограничивает интервал [*x1, *x2] значениями x, для которых a * x + b
+   находится в диапазоне [low, high]. Возвращает FALSE, если интервал стал пустым. */
+static inline gboolean
+_spanLimit (gdouble  a,
+            gdouble  b,
+            gdouble  low,
+            gdouble  high,
+            gdouble *x1,
+            gdouble *x2)
+{
+  gdouble t1, t2;
+
+  if (a == 0.0)
+    return (b >= low) && (b <= high);
+
+  t1 = (low - b) / a;
+  t2 = (high - b) / a;
+  if (t1 > t2)
+    {
+      gdouble swaptmp = t1;
+      t1 = t2;
+      t2 = swaptmp;
+    }
+
+  *x1 = MAX (*x1, t1);
+  *x2 = MIN (*x2, t2);
+
+  return *x1 <= *x2;
+}
+
+/* Минимальная высота полосы поверхности при многопоточном рисовании. */
+#define MIN_BAND_HEIGHT        16
+
+/* Типы команд рисования. */
+typedef enum
+{
+  _SDLINE_COMMAND_CLEAR,
+  _SDLINE_COMMAND_CLEAR_COLOR,
+  _SDLINE_COMMAND_H,
+  _SDLINE_COMMAND_V,
+  _SDLINE_COMMAND_LINE,
+  _SDLINE_COMMAND_AA,
+  _SDLINE_COMMAND_THICK,
+  _SDLINE_COMMAND_BAR,
+  _SDLINE_COMMAND_DOT,
+  _SDLINE_COMMAND_MARKERS,
+  _SDLINE_COMMAND_MASK
+} _sdlineCommandType;
+
+/* Команда рисования. */
+typedef struct
+{
+  _sdlineCommandType   type;                   /* Тип команды. */
+  cairo_sdline_blend   blend;                  /* Режим смешивания на момент записи. */
+  guint32              color;                  /* Цвет. */
+  gdouble              x1;                     /* Координаты примитива. */
+  gdouble              y1;
+  gdouble              x2;
+  gdouble              y2;
+  gdouble              width;                  /* Толщина линии. */
+  cairo_sdline_marker *marker;                 /* Маркер. */
+  cairo_sdline_surface *mask;                  /* Маска. */
+  guint                offset;                 /* Смещение координат маркеров в массиве points. */
+  guint                n_points;               /* Число маркеров. */
+} _sdlineCommand;
+
+/* Список команд рисования. */
+struct _cairo_sdline_commands
+{
+  GArray              *commands;               /* Команды в порядке записи. */
+  GArray              *points;                 /* Координаты маркеров (пары x, y). */
+  guint                n_primitives;           /* Число примитивов, каждый маркер считается отдельно. */
+};
+
+/* Задание на рисование полосы поверхности. */
+typedef struct
+{
+  GMutex               mutex;                  /* Блокировка счётчика. */
+  GCond                cond;                   /* Сигнал завершения рисования всех полос. */
+  guint                pending;                /* Число полос в процессе рисования. */
+} _sdlineReplayJob;
+
+/* Полоса поверхности для рисования в отдельном потоке. */
+typedef struct
+{
+  cairo_sdline_surface surface;                /* Копия поверхности, ограниченная полосой. */
+  cairo_sdline_commands *commands;             /* Воспроизводимые команды. */
+  gint32               dx;                     /* Смещение примитивов по горизонтали. */
+  gint32               dy;                     /* Смещение примитивов по вертикали. */
+  _sdlineReplayJob    *job;                    /* Задание на рисование. */
+} _sdlineBand;
+
+/* Функция добавляет команду в список записи поверхности. */
+static _sdlineCommand *
+_commandAppend (cairo_sdline_surface *surface,
+                _sdlineCommandType    type,
+                guint32               color)
+{
+  GArray *commands = surface->recording->commands;
+  _sdlineCommand *command;
+
+  g_array_set_size (commands, commands->len + 1);
+  command = &g_array_index (commands, _sdlineCommand, commands->len - 1);
+  command->type = type;
+  command->blend = surface->blend;
+  command->color = color;
+  surface->recording->n_primitives += 1;
+
+  return command;
+}
+
+/* Функция добавляет команду с координатами в список записи поверхности. */
+static _sdlineCommand *
+_commandRecord (cairo_sdline_surface *surface,
+                _sdlineCommandType    type,
+                gdouble               x1,
+                gdouble               y1,
+                gdouble               x2,
+                gdouble               y2,
+                guint32               color)
+{
+  _sdlineCommand *command = _commandAppend (surface, type, color);
+
+  command->x1 = x1;
+  command->y1 = y1;
+  command->x2 = x2;
+  command->y2 = y2;
+
+  return command;
+}
+
 /* Функция устанавливает значение цвета для контекста рисования cairo. */
 void
 cairo_sdline_set_cairo_color (cairo_t *cairo,
@@ -238,15 +705,26 @@ cairo_sdline_set_cairo_color (cairo_t *cairo,
 cairo_sdline_surface *
 cairo_sdline_surface_create (gint32 width,
                              gint32 height)
+{
+  return cairo_sdline_surface_create_with_format (CAIRO_FORMAT_ARGB32, width, height);
+}
+
+/* Функция создаёт поверхность для рисования указанного формата и размера. */
+cairo_sdline_surface *
+cairo_sdline_surface_create_with_format (cairo_format_t format,
+                                         gint32         width,
+                                         gint32         height)
 {
   cairo_surface_t *cairo_surface;
   cairo_sdline_surface *surface;
 
-  cairo_surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cairo_surface = cairo_image_surface_create (format, width, height);
   surface = cairo_sdline_surface_create_for (cairo_surface);
 
   if (surface != NULL)
     surface->self_create = TRUE;
+  else
+    cairo_surface_destroy (cairo_surface);
 
   return surface;
 }
@@ -260,9 +738,17 @@ cairo_sdline_surface_create_for (cairo_surface_t *cairo_surface)
   if (cairo_surface_get_type (cairo_surface) != CAIRO_SURFACE_TYPE_IMAGE)
     return NULL;
 
-  if ((cairo_image_surface_get_format (cairo_surface) != CAIRO_FORMAT_ARGB32) &&
-      (cairo_image_surface_get_format (cairo_surface) != CAIRO_FORMAT_RGB24))
-    return NULL;
+  switch (cairo_image_surface_get_format (cairo_surface))
+    {
+    case CAIRO_FORMAT_ARGB32:
+    case CAIRO_FORMAT_RGB24:
+    case CAIRO_FORMAT_RGB16_565:
+    case CAIRO_FORMAT_A8:
+      break;
+
+    default:
+      return NULL;
+    }
 
   surface = g_slice_new (cairo_sdline_surface);
   surface->cairo = cairo_create (cairo_surface);
@@ -271,7 +757,17 @@ cairo_sdline_surface_create_for (cairo_surface_t *cairo_surface)
   surface->height = cairo_image_surface_get_height (cairo_surface);
   surface->stride = cairo_image_surface_get_stride (cairo_surface);
   surface->data = cairo_image_surface_get_data (cairo_surface);
+  surface->format = cairo_image_surface_get_format (cairo_surface);
+  surface->pixel_size = _surfaceKernels (surface->format)->pixel_size;
   surface->self_create = FALSE;
+  surface->blend = CAIRO_SDLINE_BLEND_COPY;
+  surface->clip_left = 0;
+  surface->clip_top = 0;
+  surface->clip_right = surface->width;
+  surface->clip_bottom = surface->height;
+  surface->clip_stack = NULL;
+  surface->recording = NULL;
+  surface->n_pixels = 0;
 
   return surface;
 }
@@ -285,12 +781,104 @@ cairo_sdline_surface_destroy (cairo_sdline_surface *surface)
 
   cairo_destroy (surface->cairo);
 
+  if (surface->clip_stack != NULL)
+    g_array_unref (surface->clip_stack);
+
   if (surface->self_create)
     cairo_surface_destroy (surface->cairo_surface);
 
   g_slice_free (cairo_sdline_surface, surface);
 }
 
+/* Функция устанавливает режим смешивания цветов для примитивов рисования. */
+void
+cairo_sdline_set_blend (cairo_sdline_surface *surface,
+                        cairo_sdline_blend    blend)
+{
+  if (surface == NULL)
+    return;
+
+  surface->blend = blend;
+}
+
+/* Функция ограничивает рисование прямоугольником. */
+void
+cairo_sdline_set_clip (cairo_sdline_surface *surface,
+                       gint32                x,
+                       gint32                y,
+                       gint32                width,
+                       gint32                height)
+{
+  if (surface == NULL)
+    return;
+
+  surface->clip_left = CLAMP (x, 0, surface->width);
+  surface->clip_top = CLAMP (y, 0, surface->height);
+  surface->clip_right = CLAMP ((gint64) x + MAX (width, 0), surface->clip_left, surface->width);
+  surface->clip_bottom = CLAMP ((gint64) y + MAX (height, 0), surface->clip_top, surface->height);
+}
+
+/* Функция снимает ограничение области рисования. */
+void
+cairo_sdline_reset_clip (cairo_sdline_surface *surface)
+{
+  if (surface == NULL)
+    return;
+
+  cairo_sdline_set_clip (surface, 0, 0, surface->width, surface->height);
+}
+
+/* Функция сохраняет текущую область рисования и ограничивает её пересечением
+   с указанным прямоугольником. */
+void
+cairo_sdline_clip_push (cairo_sdline_surface *surface,
+                        gint32                x,
+                        gint32                y,
+                        gint32                width,
+                        gint32                height)
+{
+  gint clip[4];
+  gint64 right, bottom;
+
+  if (surface == NULL)
+    return;
+
+  if (surface->clip_stack == NULL)
+    surface->clip_stack = g_array_new (FALSE, FALSE, sizeof (clip));
+
+  clip[0] = surface->clip_left;
+  clip[1] = surface->clip_top;
+  clip[2] = surface->clip_right;
+  clip[3] = surface->clip_bottom;
+  g_array_append_val (surface->clip_stack, clip);
+
+  right = (gint64) x + MAX (width, 0);
+  bottom = (gint64) y + MAX (height, 0);
+
+  surface->clip_left = CLAMP (x, clip[0], clip[2]);
+  surface->clip_top = CLAMP (y, clip[1], clip[3]);
+  surface->clip_right = CLAMP (right, surface->clip_left, clip[2]);
+  surface->clip_bottom = CLAMP (bottom, surface->clip_top, clip[3]);
+}
+
+/* Функция восстанавливает область рисования, сохранённую функцией cairo_sdline_clip_push. */
+void
+cairo_sdline_clip_pop (cairo_sdline_surface *surface)
+{
+  gint *clip;
+
+  if ((surface == NULL) || (surface->clip_stack == NULL) || (surface->clip_stack->len == 0))
+    return;
+
+  clip = &g_array_index (surface->clip_stack, gint, 4 * (surface->clip_stack->len - 1));
+  surface->clip_left = clip[0];
+  surface->clip_top = clip[1];
+  surface->clip_right = clip[2];
+  surface->clip_bottom = clip[3];
+
+  g_array_set_size (surface->clip_stack, surface->clip_stack->len - 1);
+}
+
 /* Функция переводит значение цвета из отдельных компонентов в упакованное 32-х битное значение. */
 guint32
 cairo_sdline_color (double red,
@@ -332,14 +920,35 @@ void
 cairo_sdline_clear (cairo_sdline_surface *surface)
 {
   size_t size;
+  gint32 i;
 
   if (surface == NULL)
     return;
 
-  size = surface->height * surface->stride;
-  size -= surface->width - surface->stride;
+  if (surface->recording != NULL)
+    {
+      _commandAppend (surface, _SDLINE_COMMAND_CLEAR, 0);
+      return;
+    }
+
+  if ((surface->clip_left >= surface->clip_right) || (surface->clip_top >= surface->clip_bottom))
+    return;
+
+  surface->n_pixels += (guint64) (surface->clip_right - surface->clip_left) *
+                       (surface->clip_bottom - surface->clip_top);
+
+  /* Область рисования во всю ширину поверхности очищается одним вызовом. */
+  if ((surface->clip_left == 0) && (surface->clip_right == surface->width))
+    {
+      size = (surface->clip_bottom - surface->clip_top - 1) * surface->stride;
+      size += surface->width * surface->pixel_size;
+      memset (PIXEL (surface, 0, surface->clip_top), 0, size);
+      return;
+    }
 
-  memset (surface->data, 0, size);
+  size = (surface->clip_right - surface->clip_left) * surface->pixel_size;
+  for (i = surface->clip_top; i < surface->clip_bottom; i++)
+    memset (PIXEL (surface, surface->clip_left, i), 0, size);
 }
 
 /* Функция заливает всю поверхность указанным цветом. */
@@ -347,17 +956,36 @@ void
 cairo_sdline_clear_color (cairo_sdline_surface *surface,
                           guint32               color)
 {
-  gint32 shift;
+  _sdlineBlender blender;
+  guchar *first;
   gint32 i;
 
   if (surface == NULL)
     return;
 
-  for (i = 0, shift = 0; i < surface->width; i++, shift += PIXEL_SIZE)
-    *(guint32*) ((guchar*)surface->data + shift) = color;
+  if (surface->recording != NULL)
+    {
+      _commandAppend (surface, _SDLINE_COMMAND_CLEAR_COLOR, color);
+      return;
+    }
+
+  if ((surface->clip_left >= surface->clip_right) || (surface->clip_top >= surface->clip_bottom))
+    return;
+
+  blender.kernels = _surfaceKernels (surface->format);
+  blender.blend = CAIRO_SDLINE_BLEND_COPY;
+  blender.native = blender.kernels->native (color);
+  blender.n_pixels = &surface->n_pixels;
+
+  first = PIXEL (surface, surface->clip_left, surface->clip_top);
+  _blendSpan (&blender, first, surface->clip_right - surface->clip_left);
 
-  for (i = 1, shift = surface->stride; i < surface->height; i++, shift += surface->width * PIXEL_SIZE)
-    memcpy ((guchar*)surface->data + shift, surface->data, surface->width * PIXEL_SIZE);
+  for (i = surface->clip_top + 1; i < surface->clip_bottom; i++)
+    memcpy (PIXEL (surface, surface->clip_left, i), first,
+            (surface->clip_right - surface->clip_left) * surface->pixel_size);
+
+  surface->n_pixels += (guint64) (surface->clip_right - surface->clip_left) *
+                       (surface->clip_bottom - surface->clip_top - 1);
 }
 
 /* Функция рисует горизонтальную линию указанным цветом. */
@@ -368,14 +996,19 @@ cairo_sdline_h (cairo_sdline_surface *surface,
                 gint32                y1,
                 guint32               color)
 {
+  _sdlineBlender blender;
   gint32 swaptmp;
-  gint32 shift;
-  gint32 i;
 
   if (surface == NULL)
     return;
 
-  if ((y1 < 0) || (y1 >= surface->height))
+  if (surface->recording != NULL)
+    {
+      _commandRecord (surface, _SDLINE_COMMAND_H, x1, y1, x2, y1, color);
+      return;
+    }
+
+  if ((y1 < surface->clip_top) || (y1 >= surface->clip_bottom))
     return;
 
   if (x1 < 0)
@@ -394,9 +1027,13 @@ cairo_sdline_h (cairo_sdline_surface *surface,
       x2 = swaptmp;
     }
 
-  shift = (y1 * surface->stride) + PIXEL_SIZE * x1;
-  for (i = x1; i <= x2; i++, shift += PIXEL_SIZE)
-    *(guint32*) ((guchar*)surface->data + shift) = color;
+  x1 = MAX (x1, surface->clip_left);
+  x2 = MIN (x2, surface->clip_right - 1);
+  if (x1 > x2)
+    return;
+
+  _blendPrepare (surface, color, &blender);
+  _blendSpan (&blender, PIXEL (surface, x1, y1), x2 - x1 + 1);
 }
 
 /* Функция рисует вертикальную линию указанным цветом. */
@@ -407,14 +1044,20 @@ cairo_sdline_v (cairo_sdline_surface *surface,
                 gint32                y2,
                 guint32               color)
 {
+  _sdlineBlender blender;
   gint32 swaptmp;
-  gint32 shift;
   gint32 i;
 
   if (surface == NULL)
     return;
 
-  if ((x1 < 0) || (x1 >= surface->width))
+  if (surface->recording != NULL)
+    {
+      _commandRecord (surface, _SDLINE_COMMAND_V, x1, y1, x1, y2, color);
+      return;
+    }
+
+  if ((x1 < surface->clip_left) || (x1 >= surface->clip_right))
     return;
 
   if (y1 < 0)
@@ -433,9 +1076,14 @@ cairo_sdline_v (cairo_sdline_surface *surface,
       y2 = swaptmp;
     }
 
-  shift = (y1 * surface->stride) + PIXEL_SIZE * x1;
-  for (i = y1; i <= y2; i++, shift += surface->stride)
-    *(guint32*) ((guchar*)surface->data + shift) = color;
+  y1 = MAX (y1, surface->clip_top);
+  y2 = MIN (y2, surface->clip_bottom - 1);
+  if (y1 > y2)
+    return;
+
+  _blendPrepare (surface, color, &blender);
+  for (i = y1; i <= y2; i++)
+    _blendPixel (&blender, PIXEL (surface, x1, i));
 }
 
 /* Функция рисует произвольную линию указанным цветом. */
@@ -450,14 +1098,26 @@ cairo_sdline (cairo_sdline_surface *surface,
   gint32 pixx, pixy;
   gint32 dx, dy;
   gint32 sx, sy;
-  gint32 x, y;
-
+  gboolean major_x;
+  gint32 major, major_sign, major_low, major_high;
+  gint32 minor, minor_sign, minor_low, minor_high;
+  gint64 minor_first, minor_last;
+  gint64 first, last, step;
+  gint64 x, y;
+
+  _sdlineBlender blender;
   gint32 swaptmp;
   guchar *pixel;
 
   if (surface == NULL)
     return;
 
+  if (surface->recording != NULL)
+    {
+      _commandRecord (surface, _SDLINE_COMMAND_LINE, x1, y1, x2, y2, color);
+      return;
+    }
+
   if (!_clipLine (surface, &x1, &y1, &x2, &y2))
     return;
 
@@ -473,6 +1133,13 @@ cairo_sdline (cairo_sdline_surface *surface,
       return;
     }
 
+  /* Линия целиком за пределами области рисования. */
+  if ((MAX (x1, x2) < surface->clip_left) || (MIN (x1, x2) >= surface->clip_right) ||
+      (MAX (y1, y2) < surface->clip_top) || (MIN (y1, y2) >= surface->clip_bottom))
+    {
+      return;
+    }
+
   dx = x2 - x1;
   dy = y2 - y1;
   sx = (dx >= 0) ? 1 : -1;
@@ -480,11 +1147,12 @@ cairo_sdline (cairo_sdline_surface *surface,
 
   dx = sx * dx + 1;
   dy = sy * dy + 1;
-  pixx = PIXEL_SIZE;
+  pixx = surface->pixel_size;
   pixy = surface->stride;
   pixel = (guchar*)surface->data + pixx * (int)x1 + pixy * (int)y1;
   pixx *= sx;
   pixy *= sy;
+  major_x = TRUE;
   if (dx < dy)
     {
       swaptmp = dx;
@@ -493,11 +1161,70 @@ cairo_sdline (cairo_sdline_surface *surface,
       swaptmp = pixx;
       pixx = pixy;
       pixy = swaptmp;
+      major_x = FALSE;
+    }
+
+  _blendPrepare (surface, color, &blender);
+
+  /* Линия целиком внутри области рисования. */
+  if ((MIN (x1, x2) >= surface->clip_left) && (MAX (x1, x2) < surface->clip_right) &&
+      (MIN (y1, y2) >= surface->clip_top) && (MAX (y1, y2) < surface->clip_bottom))
+    {
+      blender.kernels->line (&blender, pixel, pixx, pixy, dx, dy);
+      surface->n_pixels += dx;
+      return;
+    }
+
+  /* Точки линии должны совпадать с рисованием без ограничения. Точка с номером x
+     вдоль основной оси смещена по второй оси на floor (x * dy / dx), поэтому номера
+     первой и последней точек внутри области рисования вычисляются сразу, а состояние
+     алгоритма переносится в первую из них. Это важно при рисовании по полосам, когда
+     каждая полоса содержит лишь небольшую часть линии. */
+  if (major_x)
+    {
+      major = x1;
+      major_sign = sx;
+      major_low = surface->clip_left;
+      major_high = surface->clip_right - 1;
+      minor = y1;
+      minor_sign = sy;
+      minor_low = surface->clip_top;
+      minor_high = surface->clip_bottom - 1;
+    }
+  else
+    {
+      major = y1;
+      major_sign = sy;
+      major_low = surface->clip_top;
+      major_high = surface->clip_bottom - 1;
+      minor = x1;
+      minor_sign = sx;
+      minor_low = surface->clip_left;
+      minor_high = surface->clip_right - 1;
     }
 
-  for (x = 0, y = 0; x < dx; x++, pixel += pixx)
+  /* Допустимые смещения вдоль основной и второй осей. */
+  first = (major_sign > 0) ? major_low - major : major - major_high;
+  last = (major_sign > 0) ? major_high - major : major - major_low;
+  minor_first = (minor_sign > 0) ? minor_low - minor : minor - minor_high;
+  minor_last = (minor_sign > 0) ? minor_high - minor : minor - minor_low;
+  minor_first = MAX (minor_first, 0);
+  if ((minor_last < minor_first) || (minor_first > dy - 1))
+    return;
+
+  /* Номера точек, смещение которых по второй оси находится в допустимых пределах. */
+  first = MAX (first, MAX (0, (minor_first * dx + dy - 1) / dy));
+  last = MIN (last, MIN (dx - 1, ((minor_last + 1) * dx + dy - 1) / dy - 1));
+  if (first > last)
+    return;
+
+  step = (first * dy) / dx;
+  pixel += first * pixx + step * pixy;
+  y = first * dy - step * dx;
+
+  for (x = first; x <= last; x++, pixel += pixx)
     {
-      *(guint32*) pixel = color;
+      _blendPixel (&blender, pixel);
       y += dy;
       if (y >= dx)
         {
@@ -507,26 +1234,235 @@ cairo_sdline (cairo_sdline_surface *surface,
     }
 }
 
-/* Функция рисует прямоугольник, закрашенный указанным цветом. */
+/* Функция рисует сглаженную линию указанным цветом (алгоритм Ву). */
 void
-cairo_sdline_bar (cairo_sdline_surface *surface,
-                  gint32                x1,
-                  gint32                y1,
-                  gint32                x2,
-                  gint32                y2,
-                  guint32               color)
+cairo_sdline_aa (cairo_sdline_surface *surface,
+                 gdouble               x1,
+                 gdouble               y1,
+                 gdouble               x2,
+                 gdouble               y2,
+                 guint32               color)
 {
-  gint32 swaptmp;
-  gint32 shift;
-  gint32 i, j;
+  _sdlineAABlender blender;
+  gboolean steep;
+  gdouble swaptmp;
+  gdouble gradient;
+  gdouble xend, yend;
+  gdouble xgap;
+  gdouble intery;
+  gint32 xpx1, xpx2;
+  gint32 ypx;
+  gint32 x;
+
+#define PLOT(px, py, c) (steep ? _blendPixelAA (surface, &blender, (py), (px), (c)) : \
+                                 _blendPixelAA (surface, &blender, (px), (py), (c)))
+#define COVERAGE(v)     ((guint32) ((v) * 256.0 + 0.5))
 
   if (surface == NULL)
     return;
 
-  if (x1 < 0)
-    x1 = 0;
-  if (x1 >= surface->width)
-    x1 = surface->width - 1;
+  if (surface->recording != NULL)
+    {
+      _commandRecord (surface, _SDLINE_COMMAND_AA, x1, y1, x2, y2, color);
+      return;
+    }
+
+  /* Центры точек поверхности в целочисленных координатах. */
+  x1 -= 0.5;
+  y1 -= 0.5;
+  x2 -= 0.5;
+  y2 -= 0.5;
+
+  if (!_clipLineAA (-1.0, -1.0, surface->width, surface->height, &x1, &y1, &x2, &y2))
+    return;
+
+  /* Линия целиком за пределами области рисования. */
+  if ((MAX (x1, x2) + 2.0 < surface->clip_left) || (MIN (x1, x2) - 2.0 >= surface->clip_right) ||
+      (MAX (y1, y2) + 2.0 < surface->clip_top) || (MIN (y1, y2) - 2.0 >= surface->clip_bottom))
+    {
+      return;
+    }
+
+  _blendPrepareAA (surface, color, &blender);
+
+  steep = fabs (y2 - y1) > fabs (x2 - x1);
+  if (steep)
+    {
+      swaptmp = x1, x1 = y1, y1 = swaptmp;
+      swaptmp = x2, x2 = y2, y2 = swaptmp;
+    }
+  if (x1 > x2)
+    {
+      swaptmp = x1, x1 = x2, x2 = swaptmp;
+      swaptmp = y1, y1 = y2, y2 = swaptmp;
+    }
+
+  gradient = (x2 - x1 > 0.0) ? (y2 - y1) / (x2 - x1) : 1.0;
+
+  /* Начальная точка. */
+  xend = floor (x1 + 0.5);
+  yend = y1 + gradient * (xend - x1);
+  xgap = 1.0 - ((x1 + 0.5) - floor (x1 + 0.5));
+  xpx1 = xend;
+  ypx = floor (yend);
+  PLOT (xpx1, ypx, COVERAGE ((1.0 - (yend - ypx)) * xgap));
+  PLOT (xpx1, ypx + 1, COVERAGE ((yend - ypx) * xgap));
+  intery = yend + gradient;
+
+  /* Конечная точка. */
+  xend = floor (x2 + 0.5);
+  yend = y2 + gradient * (xend - x2);
+  xgap = (x2 + 0.5) - floor (x2 + 0.5);
+  xpx2 = xend;
+  ypx = floor (yend);
+  if (xpx2 != xpx1)
+    {
+      PLOT (xpx2, ypx, COVERAGE ((1.0 - (yend - ypx)) * xgap));
+      PLOT (xpx2, ypx + 1, COVERAGE ((yend - ypx) * xgap));
+    }
+
+  /* Промежуточные точки. */
+  for (x = xpx1 + 1; x < xpx2; x++, intery += gradient)
+    {
+      ypx = floor (intery);
+      PLOT (x, ypx, COVERAGE (1.0 - (intery - ypx)));
+      PLOT (x, ypx + 1, COVERAGE (intery - ypx));
+    }
+
+#undef PLOT
+#undef COVERAGE
+}
+
+/* Функция рисует линию толщиной width точек с закруглёнными концами указанным цветом.
+   Линия заполняется по строкам: в каждой строке рисуется отрезок точек, центры которых
+   находятся на расстоянии не больше width / 2 от линии. Закруглённые концы соседних
+   отрезков ломаной образуют скруглённые соединения. */
+void
+cairo_sdline_thick (cairo_sdline_surface *surface,
+                    gdouble               x1,
+                    gdouble               y1,
+                    gdouble               x2,
+                    gdouble               y2,
+                    gdouble               width,
+                    guint32               color)
+{
+  _sdlineBlender blender;
+  gdouble radius = width / 2.0;
+  gdouble dx = x2 - x1;
+  gdouble dy = y2 - y1;
+  gdouble length2 = dx * dx + dy * dy;
+  gdouble length = sqrt (length2);
+  gdouble left, right;
+  gdouble span1, span2;
+  gdouble ry, h;
+  gint32 row, row_end;
+  gint32 px1, px2;
+
+  if (surface == NULL)
+    return;
+
+  if (surface->recording != NULL)
+    {
+      _commandRecord (surface, _SDLINE_COMMAND_THICK, x1, y1, x2, y2, color)->width = width;
+      return;
+    }
+
+  /* Центры точек поверхности находятся в координатах (i + 0.5),
+     для тонкой линии выбираем ближайшие к концам отрезка точки. */
+  if (width <= 1.0)
+    {
+      cairo_sdline (surface, lround (x1 - 0.5), lround (y1 - 0.5),
+                    lround (x2 - 0.5), lround (y2 - 0.5), color);
+      return;
+    }
+
+  /* Отбрасываем линии за пределами поверхности. */
+  if ((MAX (x1, x2) + radius < 0.0) || (MIN (x1, x2) - radius > surface->width) ||
+      (MAX (y1, y2) + radius < 0.0) || (MIN (y1, y2) - radius > surface->height))
+    {
+      return;
+    }
+
+  row = MAX ((gdouble) surface->clip_top, floor (MIN (y1, y2) - radius));
+  row_end = MIN (surface->clip_bottom - 1.0, ceil (MAX (y1, y2) + radius));
+
+  _blendPrepare (surface, color, &blender);
+
+  for (; row <= row_end; row++)
+    {
+      ry = row + 0.5;
+      left = G_MAXDOUBLE;
+      right = -G_MAXDOUBLE;
+
+      /* Закруглённые концы. */
+      if (fabs (ry - y1) <= radius)
+        {
+          h = sqrt (radius * radius - (ry - y1) * (ry - y1));
+          left = MIN (left, x1 - h);
+          right = MAX (right, x1 + h);
+        }
+      if (fabs (ry - y2) <= radius)
+        {
+          h = sqrt (radius * radius - (ry - y2) * (ry - y2));
+          left = MIN (left, x2 - h);
+          right = MAX (right, x2 + h);
+        }
+
+      /* Прямоугольник вдоль линии: расстояние до линии не больше radius,
+         проекция на линию между её концами. */
+      if (length > 0.0)
+        {
+          span1 = -G_MAXDOUBLE;
+          span2 = G_MAXDOUBLE;
+          if (_spanLimit (-dy / length, (x1 * dy + (ry - y1) * dx) / length, -radius, radius, &span1, &span2) &&
+              _spanLimit (dx, (ry - y1) * dy - x1 * dx, 0.0, length2, &span1, &span2))
+            {
+              left = MIN (left, span1);
+              right = MAX (right, span2);
+            }
+        }
+
+      if (left > right)
+        continue;
+
+      /* Точки, центры которых попадают в отрезок строки. */
+      left = MAX (ceil (left - 0.5), (gdouble) surface->clip_left);
+      right = MIN (floor (right - 0.5), surface->clip_right - 1.0);
+      if (left > right)
+        continue;
+
+      px1 = left;
+      px2 = right;
+      _blendSpan (&blender, PIXEL (surface, px1, row), px2 - px1 + 1);
+    }
+}
+
+/* Функция рисует прямоугольник, закрашенный указанным цветом. */
+void
+cairo_sdline_bar (cairo_sdline_surface *surface,
+                  gint32                x1,
+                  gint32                y1,
+                  gint32                x2,
+                  gint32                y2,
+                  guint32               color)
+{
+  _sdlineBlender blender;
+  gint32 swaptmp;
+  gint32 j;
+
+  if (surface == NULL)
+    return;
+
+  if (surface->recording != NULL)
+    {
+      _commandRecord (surface, _SDLINE_COMMAND_BAR, x1, y1, x2, y2, color);
+      return;
+    }
+
+  if (x1 < 0)
+    x1 = 0;
+  if (x1 >= surface->width)
+    x1 = surface->width - 1;
 
   if (x2 < 0)
     x2 = 0;
@@ -555,12 +1491,16 @@ cairo_sdline_bar (cairo_sdline_surface *surface,
       y2 = swaptmp;
     }
 
+  x1 = MAX (x1, surface->clip_left);
+  x2 = MIN (x2, surface->clip_right - 1);
+  y1 = MAX (y1, surface->clip_top);
+  y2 = MIN (y2, surface->clip_bottom - 1);
+  if (x1 > x2)
+    return;
+
+  _blendPrepare (surface, color, &blender);
   for (j = y1; j <= y2; j++)
-    {
-      shift = (j * surface->stride) + PIXEL_SIZE * x1;
-      for (i = x1; i <= x2; i++, shift += PIXEL_SIZE)
-        *(guint32*)((guchar*)surface->data + shift) = color;
-    }
+    _blendSpan (&blender, PIXEL (surface, x1, j), x2 - x1 + 1);
 }
 
 /* Функция рисует точку указанным цветом. */
@@ -570,17 +1510,613 @@ cairo_sdline_dot (cairo_sdline_surface *surface,
                   gint32                y,
                   guint32               color)
 {
-  gint32 shift;
+  _sdlineBlender blender;
 
   if (surface == NULL)
     return;
 
-  if (x < 0 || y < 0)
+  if (surface->recording != NULL)
+    {
+      _commandRecord (surface, _SDLINE_COMMAND_DOT, x, y, x, y, color);
+      return;
+    }
+
+  if (!_clipContains (surface, x, y))
+    return;
+
+  _blendPrepare (surface, color, &blender);
+  _blendPixel (&blender, PIXEL (surface, x, y));
+}
+
+/* Функция накладывает цвет через маску. */
+void
+cairo_sdline_mask (cairo_sdline_surface *surface,
+                   cairo_sdline_surface *mask,
+                   gint32                x,
+                   gint32                y,
+                   guint32               color)
+{
+  _sdlineBlender blender;
+  gint32 left, top, right, bottom;
+  guint32 alpha, prev_alpha;
+  guint8 *src;
+  gint32 i, j;
+
+  if ((surface == NULL) || (mask == NULL) || (mask->format != CAIRO_FORMAT_A8))
+    return;
+
+  if (surface->recording != NULL)
+    {
+      _commandRecord (surface, _SDLINE_COMMAND_MASK, x, y, x, y, color)->mask = mask;
+      return;
+    }
+
+  left = MAX (x, surface->clip_left);
+  top = MAX (y, surface->clip_top);
+  right = MIN ((gint64) x + mask->width, surface->clip_right);
+  bottom = MIN ((gint64) y + mask->height, surface->clip_bottom);
+  if ((left >= right) || (top >= bottom))
+    return;
+
+  /* Цвет каждой точки получает альфа канал маски. Параметры смешивания
+     пересчитываются только при изменении значения маски. */
+  prev_alpha = 0;
+  for (i = top; i < bottom; i++)
+    {
+      src = PIXEL (mask, left - x, i - y);
+      for (j = left; j < right; j++, src++)
+        {
+          alpha = *src;
+          if (alpha == 0)
+            continue;
+
+          if (alpha != prev_alpha)
+            {
+              _blendPrepare (surface, (alpha << 24) | (color & 0x00FFFFFF), &blender);
+              prev_alpha = alpha;
+            }
+          _blendPixel (&blender, PIXEL (surface, j, i));
+        }
+    }
+}
+
+/* Функция копирует прямоугольную область поверхности. */
+void
+cairo_sdline_copy_region (cairo_sdline_surface *surface,
+                          gint32                src_x,
+                          gint32                src_y,
+                          gint32                width,
+                          gint32                height,
+                          gint32                dst_x,
+                          gint32                dst_y)
+{
+  gint32 left, top, right, bottom;
+  gint32 row_size;
+  gint32 i;
+
+  if (surface == NULL)
     return;
 
-  if (x >= surface->width || y >= surface->height)
+  /* Записанные команды воспроизводятся позже, копирование выполнялось бы
+     не в порядке рисования. */
+  g_return_if_fail (surface->recording == NULL);
+
+  /* Область назначения ограничивается областью рисования,
+     а область источника - поверхностью. */
+  left = MAX (dst_x, MAX (surface->clip_left, dst_x - src_x));
+  top = MAX (dst_y, MAX (surface->clip_top, dst_y - src_y));
+  right = MIN ((gint64) dst_x + width, MIN (surface->clip_right, (gint64) dst_x - src_x + surface->width));
+  bottom = MIN ((gint64) dst_y + height, MIN (surface->clip_bottom, (gint64) dst_y - src_y + surface->height));
+  if ((left >= right) || (top >= bottom))
     return;
 
-  shift = (y * surface->stride) + PIXEL_SIZE * x;
-  *(guint32*) ((guchar*)surface->data + shift) = color;
+  src_x += left - dst_x;
+  src_y += top - dst_y;
+  row_size = (right - left) * surface->pixel_size;
+
+  /* При сдвиге вниз строки копируются снизу вверх, чтобы не затереть ещё
+     не скопированные строки. Перекрытие внутри строки обрабатывает memmove. */
+  if (top > src_y)
+    {
+      for (i = bottom - top - 1; i >= 0; i--)
+        memmove (PIXEL (surface, left, top + i), PIXEL (surface, src_x, src_y + i), row_size);
+    }
+  else
+    {
+      for (i = 0; i < bottom - top; i++)
+        memmove (PIXEL (surface, left, top + i), PIXEL (surface, src_x, src_y + i), row_size);
+    }
+}
+
+/* Функция сдвигает изображение в области рисования. */
+guint
+cairo_sdline_scroll (cairo_sdline_surface *surface,
+                     gint32                dx,
+                     gint32                dy,
+                     cairo_sdline_rect    *exposed)
+{
+  gint32 left, top, width, height;
+  gint32 adx, ady;
+  guint n_exposed = 0;
+
+  if (surface == NULL)
+    return 0;
+
+  g_return_val_if_fail (surface->recording == NULL, 0);
+
+  left = surface->clip_left;
+  top = surface->clip_top;
+  width = surface->clip_right - surface->clip_left;
+  height = surface->clip_bottom - surface->clip_top;
+  if ((width <= 0) || (height <= 0) || ((dx == 0) && (dy == 0)))
+    return 0;
+
+  adx = ABS (dx);
+  ady = ABS (dy);
+
+  /* Изображение сдвинуто целиком за пределы области рисования. */
+  if ((adx >= width) || (ady >= height))
+    {
+      exposed[0].x = left;
+      exposed[0].y = top;
+      exposed[0].width = width;
+      exposed[0].height = height;
+      return 1;
+    }
+
+  cairo_sdline_copy_region (surface, left + MAX (-dx, 0), top + MAX (-dy, 0),
+                            width - adx, height - ady, left + MAX (dx, 0), top + MAX (dy, 0));
+
+  /* Открывшиеся столбцы на всю высоту области рисования. */
+  if (dx != 0)
+    {
+      exposed[n_exposed].x = (dx > 0) ? left : left + width - adx;
+      exposed[n_exposed].y = top;
+      exposed[n_exposed].width = adx;
+      exposed[n_exposed].height = height;
+      n_exposed += 1;
+    }
+
+  /* Открывшиеся строки без уже учтённых столбцов. */
+  if (dy != 0)
+    {
+      exposed[n_exposed].x = left + MAX (dx, 0);
+      exposed[n_exposed].y = (dy > 0) ? top : top + height - ady;
+      exposed[n_exposed].width = width - adx;
+      exposed[n_exposed].height = ady;
+      n_exposed += 1;
+    }
+
+  return n_exposed;
+}
+
+/* Функция рисует маркер, целиком находящийся внутри области рисования. */
+static inline void
+_markerUnclipped (cairo_sdline_surface *surface,
+                  cairo_sdline_marker  *marker,
+                  gint32                x,
+                  gint32                y,
+                  _sdlineBlender       *blender)
+{
+  cairo_sdline_span *span;
+  guint n;
+
+  for (n = 0, span = marker->spans; n < marker->n_spans; n++, span++)
+    _blendSpan (blender, PIXEL (surface, x + span->x1, y + span->y), span->x2 - span->x1 + 1);
+}
+
+/* Функция рисует маркер, частично выходящий за границы области рисования. */
+static void
+_markerClipped (cairo_sdline_surface *surface,
+                cairo_sdline_marker  *marker,
+                gint32                x,
+                gint32                y,
+                _sdlineBlender       *blender)
+{
+  cairo_sdline_span *span;
+  gint32 x1, x2;
+  guint n;
+
+  for (n = 0, span = marker->spans; n < marker->n_spans; n++, span++)
+    {
+      if ((y + span->y < surface->clip_top) || (y + span->y >= surface->clip_bottom))
+        continue;
+
+      x1 = MAX (x + span->x1, surface->clip_left);
+      x2 = MIN (x + span->x2, surface->clip_right - 1);
+      if (x1 <= x2)
+        _blendSpan (blender, PIXEL (surface, x1, y + span->y), x2 - x1 + 1);
+    }
+}
+
+/* Функция рисует маркер с проверкой его положения относительно границ области рисования. */
+static inline void
+_markerDraw (cairo_sdline_surface *surface,
+             cairo_sdline_marker  *marker,
+             gint32                x,
+             gint32                y,
+             _sdlineBlender       *blender)
+{
+  gint32 radius = marker->radius;
+
+  /* Маркер внутри области рисования. */
+  if ((x >= surface->clip_left + radius) && (y >= surface->clip_top + radius) &&
+      (x < surface->clip_right - radius) && (y < surface->clip_bottom - radius))
+    {
+      _markerUnclipped (surface, marker, x, y, blender);
+    }
+
+  /* Маркер частично виден. */
+  else if ((x > surface->clip_left - radius - 1) && (y > surface->clip_top - radius - 1) &&
+           (x < surface->clip_right + radius) && (y < surface->clip_bottom + radius))
+    {
+      _markerClipped (surface, marker, x, y, blender);
+    }
+}
+
+/* Функция создаёт маркер указанной формы и размера. */
+cairo_sdline_marker *
+cairo_sdline_marker_create (cairo_sdline_marker_shape shape,
+                            gint32                    radius)
+{
+  cairo_sdline_marker *marker;
+  cairo_sdline_span *span;
+  gint32 dy;
+
+  if (radius < 0)
+    radius = 0;
+
+  marker = g_slice_new (cairo_sdline_marker);
+  marker->radius = radius;
+  marker->n_spans = 2 * radius + 1;
+  marker->spans = g_new (cairo_sdline_span, marker->n_spans);
+
+  /* Отрезки строк маркера сверху вниз. */
+  for (dy = -radius, span = marker->spans; dy <= radius; dy++, span++)
+    {
+      span->y = dy;
+
+      switch (shape)
+        {
+        case CAIRO_SDLINE_MARKER_CROSS:
+          span->x1 = (dy == 0) ? -radius : 0;
+          span->x2 = (dy == 0) ? radius : 0;
+          break;
+
+        case CAIRO_SDLINE_MARKER_CIRCLE:
+          span->x2 = sqrt ((radius + 0.5) * (radius + 0.5) - (dy * dy));
+          span->x1 = -span->x2;
+          break;
+
+        case CAIRO_SDLINE_MARKER_TRIANGLE:
+          span->x2 = (dy + radius) / 2;
+          span->x1 = -span->x2;
+          break;
+
+        default:
+          span->x1 = -radius;
+          span->x2 = radius;
+          break;
+        }
+    }
+
+  return marker;
+}
+
+/* Функция удаляет маркер. */
+void
+cairo_sdline_marker_destroy (cairo_sdline_marker *marker)
+{
+  if (marker == NULL)
+    return;
+
+  g_free (marker->spans);
+  g_slice_free (cairo_sdline_marker, marker);
+}
+
+/* Функция рисует маркер с центром в указанной точке. */
+void
+cairo_sdline_marker_draw (cairo_sdline_surface *surface,
+                          cairo_sdline_marker  *marker,
+                          gint32                x,
+                          gint32                y,
+                          guint32               color)
+{
+  _sdlineBlender blender;
+
+  if ((surface == NULL) || (marker == NULL))
+    return;
+
+  if (surface->recording != NULL)
+    {
+      cairo_sdline_marker_draw_array (surface, marker, (gint32[]) { x, y }, 1, color);
+      return;
+    }
+
+  _blendPrepare (surface, color, &blender);
+  _markerDraw (surface, marker, x, y, &blender);
+}
+
+/* Функция рисует маркеры с центрами в точках массива points (пары координат x, y). */
+void
+cairo_sdline_marker_draw_array (cairo_sdline_surface *surface,
+                                cairo_sdline_marker  *marker,
+                                const gint32         *points,
+                                guint                 n_points,
+                                guint32               color)
+{
+  _sdlineBlender blender;
+  guint i;
+
+  if ((surface == NULL) || (marker == NULL) || (n_points == 0))
+    return;
+
+  if (surface->recording != NULL)
+    {
+      _sdlineCommand *command = _commandAppend (surface, _SDLINE_COMMAND_MARKERS, color);
+
+      command->marker = marker;
+      command->offset = surface->recording->points->len;
+      command->n_points = n_points;
+      g_array_append_vals (surface->recording->points, points, 2 * n_points);
+      surface->recording->n_primitives += n_points - 1;
+      return;
+    }
+
+  _blendPrepare (surface, color, &blender);
+  for (i = 0; i < n_points; i++, points += 2)
+    _markerDraw (surface, marker, points[0], points[1], &blender);
+}
+
+/* Функция создаёт пустой список команд рисования. */
+cairo_sdline_commands *
+cairo_sdline_commands_new (void)
+{
+  cairo_sdline_commands *commands;
+
+  commands = g_slice_new (cairo_sdline_commands);
+  commands->commands = g_array_new (FALSE, FALSE, sizeof (_sdlineCommand));
+  commands->points = g_array_new (FALSE, FALSE, sizeof (gint32));
+  commands->n_primitives = 0;
+
+  return commands;
+}
+
+/* Функция удаляет список команд рисования. */
+void
+cairo_sdline_commands_free (cairo_sdline_commands *commands)
+{
+  if (commands == NULL)
+    return;
+
+  g_array_unref (commands->commands);
+  g_array_unref (commands->points);
+  g_slice_free (cairo_sdline_commands, commands);
+}
+
+/* Функция удаляет все команды из списка. */
+void
+cairo_sdline_commands_clear (cairo_sdline_commands *commands)
+{
+  if (commands == NULL)
+    return;
+
+  g_array_set_size (commands->commands, 0);
+  g_array_set_size (commands->points, 0);
+  commands->n_primitives = 0;
+}
+
+/* Функция возвращает число примитивов в списке команд. */
+guint
+cairo_sdline_commands_get_n_primitives (cairo_sdline_commands *commands)
+{
+  if (commands == NULL)
+    return 0;
+
+  return commands->n_primitives;
+}
+
+/* Функция включает или отключает запись команд рисования. */
+void
+cairo_sdline_surface_set_recording (cairo_sdline_surface  *surface,
+                                    cairo_sdline_commands *commands)
+{
+  if (surface == NULL)
+    return;
+
+  surface->recording = commands;
+}
+
+/* Функция воспроизводит команды рисования на поверхности в одном потоке. */
+static void
+_commandsReplay (cairo_sdline_surface  *surface,
+                 cairo_sdline_commands *commands,
+                 gint32                 dx,
+                 gint32                 dy)
+{
+  _sdlineCommand *command;
+  const gint32 *points;
+  guint i, j;
+
+  for (i = 0; i < commands->commands->len; i++)
+    {
+      command = &g_array_index (commands->commands, _sdlineCommand, i);
+      surface->blend = command->blend;
+
+      switch (command->type)
+        {
+        case _SDLINE_COMMAND_CLEAR:
+          cairo_sdline_clear (surface);
+          break;
+
+        case _SDLINE_COMMAND_CLEAR_COLOR:
+          cairo_sdline_clear_color (surface, command->color);
+          break;
+
+        case _SDLINE_COMMAND_H:
+          cairo_sdline_h (surface, command->x1 + dx, command->x2 + dx, command->y1 + dy, command->color);
+          break;
+
+        case _SDLINE_COMMAND_V:
+          cairo_sdline_v (surface, command->x1 + dx, command->y1 + dy, command->y2 + dy, command->color);
+          break;
+
+        case _SDLINE_COMMAND_LINE:
+          cairo_sdline (surface, command->x1 + dx, command->y1 + dy,
+                        command->x2 + dx, command->y2 + dy, command->color);
+          break;
+
+        case _SDLINE_COMMAND_AA:
+          cairo_sdline_aa (surface, command->x1 + dx, command->y1 + dy,
+                           command->x2 + dx, command->y2 + dy, command->color);
+          break;
+
+        case _SDLINE_COMMAND_THICK:
+          cairo_sdline_thick (surface, command->x1 + dx, command->y1 + dy,
+                              command->x2 + dx, command->y2 + dy, command->width, command->color);
+          break;
+
+        case _SDLINE_COMMAND_BAR:
+          cairo_sdline_bar (surface, command->x1 + dx, command->y1 + dy,
+                            command->x2 + dx, command->y2 + dy, command->color);
+          break;
+
+        case _SDLINE_COMMAND_DOT:
+          cairo_sdline_dot (surface, command->x1 + dx, command->y1 + dy, command->color);
+          break;
+
+        case _SDLINE_COMMAND_MARKERS:
+          points = &g_array_index (commands->points, gint32, command->offset);
+          if ((dx == 0) && (dy == 0))
+            {
+              cairo_sdline_marker_draw_array (surface, command->marker, points,
+                                              command->n_points, command->color);
+            }
+          else
+            {
+              for (j = 0; j < command->n_points; j++, points += 2)
+                cairo_sdline_marker_draw (surface, command->marker, points[0] + dx, points[1] + dy, command->color);
+            }
+          break;
+
+        case _SDLINE_COMMAND_MASK:
+          cairo_sdline_mask (surface, command->mask, command->x1 + dx, command->y1 + dy, command->color);
+          break;
+        }
+    }
+}
+
+/* Функция рисования полосы поверхности в потоке. */
+static void
+_bandReplay (gpointer data,
+             gpointer user_data)
+{
+  _sdlineBand *band = data;
+  _sdlineReplayJob *job = band->job;
+
+  _commandsReplay (&band->surface, band->commands, band->dx, band->dy);
+
+  g_mutex_lock (&job->mutex);
+  if (--job->pending == 0)
+    g_cond_signal (&job->cond);
+  g_mutex_unlock (&job->mutex);
+}
+
+/* Функция возвращает общий для всех поверхностей пул потоков рисования. */
+static GThreadPool *
+_bandPool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool))
+    g_once_init_leave (&pool, g_thread_pool_new (_bandReplay, NULL, g_get_num_processors (), FALSE, NULL));
+
+  return pool;
+}
+
+/* Функция воспроизводит команды рисования на поверхности. */
+void
+cairo_sdline_commands_replay (cairo_sdline_surface  *surface,
+                              cairo_sdline_commands *commands,
+                              guint                  n_threads)
+{
+  cairo_sdline_commands_replay_offset (surface, commands, 0, 0, n_threads);
+}
+
+/* Функция воспроизводит команды рисования на поверхности со смещением. */
+void
+cairo_sdline_commands_replay_offset (cairo_sdline_surface  *surface,
+                                     cairo_sdline_commands *commands,
+                                     gint32                 dx,
+                                     gint32                 dy,
+                                     guint                  n_threads)
+{
+  _sdlineReplayJob job;
+  _sdlineBand *bands;
+  cairo_sdline_blend blend;
+  GThreadPool *pool;
+  guint64 n_pixels;
+  gint rows;
+  guint n_bands;
+  guint i;
+
+  if ((surface == NULL) || (commands == NULL))
+    return;
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  rows = surface->clip_bottom - surface->clip_top;
+  n_bands = MIN (n_threads, (guint) MAX (rows, 0) / MIN_BAND_HEIGHT);
+
+  /* Рисование в одном потоке, в том числе запись в другой список команд. */
+  if ((n_bands <= 1) || (surface->recording != NULL))
+    {
+      blend = surface->blend;
+      _commandsReplay (surface, commands, dx, dy);
+      surface->blend = blend;
+      if (surface->recording == NULL)
+        cairo_surface_mark_dirty (surface->cairo_surface);
+      return;
+    }
+
+  g_mutex_init (&job.mutex);
+  g_cond_init (&job.cond);
+  job.pending = n_bands - 1;
+
+  /* Полосы не пересекаются, поэтому рисуются без блокировок. */
+  bands = g_new (_sdlineBand, n_bands);
+  for (i = 0; i < n_bands; i++)
+    {
+      bands[i].surface = *surface;
+      bands[i].surface.clip_top = surface->clip_top + (rows * i) / n_bands;
+      bands[i].surface.clip_bottom = surface->clip_top + (rows * (i + 1)) / n_bands;
+      bands[i].surface.clip_stack = NULL;
+      bands[i].commands = commands;
+      bands[i].dx = dx;
+      bands[i].dy = dy;
+      bands[i].job = &job;
+    }
+
+  /* Первую полосу рисуем в текущем потоке. */
+  pool = _bandPool ();
+  for (i = 1; i < n_bands; i++)
+    g_thread_pool_push (pool, &bands[i], NULL);
+  _commandsReplay (&bands[0].surface, commands, dx, dy);
+
+  g_mutex_lock (&job.mutex);
+  while (job.pending > 0)
+    g_cond_wait (&job.cond, &job.mutex);
+  g_mutex_unlock (&job.mutex);
+
+  /* Счётчики пикселей полос начинались со значения счётчика поверхности. */
+  n_pixels = surface->n_pixels;
+  for (i = 0; i < n_bands; i++)
+    surface->n_pixels += bands[i].surface.n_pixels - n_pixels;
+
+  g_mutex_clear (&job.mutex);
+  g_cond_clear (&job.cond);
+  g_free (bands);
+
+  cairo_surface_mark_dirty (surface->cairo_surface);
 }
@@ -42,6 +42,18 @@
 
 G_BEGIN_DECLS
 
+/* Режимы смешивания цветов. */
+typedef enum
+{
+  CAIRO_SDLINE_BLEND_COPY,                     /* Замена пикселей цветом. */
+  CAIRO_SDLINE_BLEND_OVER,                     /* Наложение с учётом прозрачности цвета. */
+  CAIRO_SDLINE_BLEND_ADD,                      /* Сложение составляющих с насыщением. */
+  CAIRO_SDLINE_BLEND_MAX                       /* Максимум по каждой составляющей. */
+} cairo_sdline_blend;
+
+/* Список команд рисования. */
+typedef struct _cairo_sdline_commands cairo_sdline_commands;
+
 /* Структура описания поверхности для рисования. */
 typedef struct
 {
@@ -53,9 +65,57 @@ typedef struct
   gint                 stride;                 /* Размер одной линии поверхности в байтах. */
 
   gpointer             data;                   /* Пиксели поверхности. */
+  cairo_format_t       format;                 /* Формат пикселей поверхности. */
+  gint                 pixel_size;             /* Размер пикселя в байтах. */
   gboolean             self_create;            /* TRUE - поверхность создавали мы, удаляем сами, иначе - FALSE. */
+
+  cairo_sdline_blend   blend;                  /* Режим смешивания цветов. */
+
+  gint                 clip_left;              /* Первый столбец области рисования. */
+  gint                 clip_top;               /* Первая строка области рисования. */
+  gint                 clip_right;             /* Столбец, следующий за последним столбцом области рисования. */
+  gint                 clip_bottom;            /* Строка, следующая за последней строкой области рисования. */
+  GArray              *clip_stack;             /* Сохранённые области рисования. */
+
+  cairo_sdline_commands *recording;            /* Список для записи команд рисования или NULL. */
+
+  guint64              n_pixels;               /* Число изменённых пикселей (для статистики). */
 } cairo_sdline_surface;
 
+/* Формы маркеров. */
+typedef enum
+{
+  CAIRO_SDLINE_MARKER_CROSS,                   /* Перекрестие. */
+  CAIRO_SDLINE_MARKER_SQUARE,                  /* Закрашенный квадрат. */
+  CAIRO_SDLINE_MARKER_CIRCLE,                  /* Закрашенный круг. */
+  CAIRO_SDLINE_MARKER_TRIANGLE                 /* Закрашенный треугольник. */
+} cairo_sdline_marker_shape;
+
+/* Отрезок строки маркера относительно его центра. */
+typedef struct
+{
+  gint32               y;                      /* Смещение строки. */
+  gint32               x1;                     /* Смещение начала отрезка. */
+  gint32               x2;                     /* Смещение конца отрезка. */
+} cairo_sdline_span;
+
+/* Прямоугольная область поверхности. */
+typedef struct
+{
+  gint32               x;                      /* Координата левого края. */
+  gint32               y;                      /* Координата верхнего края. */
+  gint32               width;                  /* Ширина. */
+  gint32               height;                 /* Высота. */
+} cairo_sdline_rect;
+
+/* Структура описания маркера. */
+typedef struct
+{
+  gint32               radius;                 /* Размер маркера от центра до края. */
+  guint                n_spans;                /* Число отрезков. */
+  cairo_sdline_span   *spans;                  /* Отрезки маркера по строкам. */
+} cairo_sdline_marker;
+
 /* Функция устанавливает значение цвета для контекста рисования cairo. */
 void                   cairo_sdline_set_cairo_color    (cairo_t               *cairo,
                                                         guint32                color);
@@ -64,12 +124,46 @@ void                   cairo_sdline_set_cairo_color    (cairo_t               *c
 cairo_sdline_surface*  cairo_sdline_surface_create     (gint32                 width,
                                                         gint32                 height);
 
+/* Функция создаёт поверхность для рисования указанного формата и размера. Поддерживаются
+   форматы ARGB32, RGB24, RGB16_565 и A8. В формате A8 сохраняется только альфа канал
+   цвета, в формате RGB16_565 - только цветовые составляющие. */
+cairo_sdline_surface*  cairo_sdline_surface_create_with_format (cairo_format_t  format,
+                                                        gint32                 width,
+                                                        gint32                 height);
+
 /* Функция создаёт поверхность для рисования для указанной поверхности cairo. */
 cairo_sdline_surface*  cairo_sdline_surface_create_for (cairo_surface_t       *cairo_surface);
 
 /* Функция удаляет поверхность для рисования. */
 void                   cairo_sdline_surface_destroy    (cairo_sdline_surface  *surface);
 
+/* Функция устанавливает режим смешивания цветов для примитивов рисования. */
+void                   cairo_sdline_set_blend          (cairo_sdline_surface  *surface,
+                                                        cairo_sdline_blend     blend);
+
+/* Функция ограничивает рисование прямоугольником. Примитивы рисуются так же, как без
+   ограничения, но изменяются только точки внутри прямоугольника. Ограничение не
+   записывается в список команд, а действует при их воспроизведении. */
+void                   cairo_sdline_set_clip           (cairo_sdline_surface  *surface,
+                                                        gint32                 x,
+                                                        gint32                 y,
+                                                        gint32                 width,
+                                                        gint32                 height);
+
+/* Функция снимает ограничение области рисования. */
+void                   cairo_sdline_reset_clip         (cairo_sdline_surface  *surface);
+
+/* Функция сохраняет текущую область рисования и ограничивает её пересечением
+   с указанным прямоугольником. */
+void                   cairo_sdline_clip_push          (cairo_sdline_surface  *surface,
+                                                        gint32                 x,
+                                                        gint32                 y,
+                                                        gint32                 width,
+                                                        gint32                 height);
+
+/* Функция восстанавливает область рисования, сохранённую функцией cairo_sdline_clip_push. */
+void                   cairo_sdline_clip_pop           (cairo_sdline_surface  *surface);
+
 /* Функция переводит значение цвета из отдельных компонентов в упакованное 32-х битное значение. */
 guint32                cairo_sdline_color              (gdouble                red,
                                                         gdouble                green,
@@ -105,6 +199,25 @@ void                   cairo_sdline                    (cairo_sdline_surface  *s
                                                         gint32                 y2,
                                                         guint32                color);
 
+/* Функция рисует сглаженную линию указанным цветом. Точка поверхности с целочисленными
+   координатами (x, y) занимает область от x до x + 1 и от y до y + 1. */
+void                   cairo_sdline_aa                 (cairo_sdline_surface  *surface,
+                                                        gdouble                x1,
+                                                        gdouble                y1,
+                                                        gdouble                x2,
+                                                        gdouble                y2,
+                                                        guint32                color);
+
+/* Функция рисует линию толщиной width точек с закруглёнными концами указанным цветом.
+   Координаты задаются так же, как для cairo_sdline_aa. */
+void                   cairo_sdline_thick              (cairo_sdline_surface  *surface,
+                                                        gdouble                x1,
+                                                        gdouble                y1,
+                                                        gdouble                x2,
+                                                        gdouble                y2,
+                                                        gdouble                width,
+                                                        guint32                color);
+
 /* Функция рисует прямоугольник, закрашенный указанным цветом. */
 void                   cairo_sdline_bar                (cairo_sdline_surface  *surface,
                                                         gint32                 x1,
@@ -119,6 +232,94 @@ void                   cairo_sdline_dot                (cairo_sdline_surface  *s
                                                         gint32                 y,
                                                         guint32                color);
 
+/* Функция накладывает цвет через маску mask формата A8, левый верхний угол которой
+   совмещён с точкой (x, y). Альфа канал цвета берётся из маски, а составляющие -
+   из color. Маска позволяет нарисовать полупрозрачную линию в ней непрозрачной
+   (режим CAIRO_SDLINE_BLEND_MAX) и наложить на поверхность один раз, без повторного
+   смешивания точек, через которые линия прошла несколько раз. Маска должна
+   существовать до воспроизведения команд. */
+void                   cairo_sdline_mask               (cairo_sdline_surface  *surface,
+                                                        cairo_sdline_surface  *mask,
+                                                        gint32                 x,
+                                                        gint32                 y,
+                                                        guint32                color);
+
+/* Функция копирует прямоугольную область поверхности размером width x height с началом
+   в точке (src_x, src_y) в точку (dst_x, dst_y). Области могут перекрываться. Изменяются
+   только точки внутри области рисования. Копирование не записывается в список команд,
+   поэтому во время записи команд функцию вызывать нельзя. */
+void                   cairo_sdline_copy_region        (cairo_sdline_surface  *surface,
+                                                        gint32                 src_x,
+                                                        gint32                 src_y,
+                                                        gint32                 width,
+                                                        gint32                 height,
+                                                        gint32                 dst_x,
+                                                        gint32                 dst_y);
+
+/* Функция сдвигает изображение в области рисования на dx, dy точек. Открывшиеся
+   области (не больше двух) не изменяются и записываются в exposed, функция возвращает
+   их число. Сдвиг не записывается в список команд, поэтому во время записи команд
+   функцию вызывать нельзя. */
+guint                  cairo_sdline_scroll             (cairo_sdline_surface  *surface,
+                                                        gint32                 dx,
+                                                        gint32                 dy,
+                                                        cairo_sdline_rect     *exposed);
+
+/* Функция создаёт маркер указанной формы и размера. */
+cairo_sdline_marker*   cairo_sdline_marker_create      (cairo_sdline_marker_shape  shape,
+                                                        gint32                 radius);
+
+/* Функция удаляет маркер. */
+void                   cairo_sdline_marker_destroy     (cairo_sdline_marker   *marker);
+
+/* Функция рисует маркер с центром в указанной точке. */
+void                   cairo_sdline_marker_draw        (cairo_sdline_surface  *surface,
+                                                        cairo_sdline_marker   *marker,
+                                                        gint32                 x,
+                                                        gint32                 y,
+                                                        guint32                color);
+
+/* Функция рисует маркеры с центрами в точках массива points (пары координат x, y). */
+void                   cairo_sdline_marker_draw_array  (cairo_sdline_surface  *surface,
+                                                        cairo_sdline_marker   *marker,
+                                                        const gint32          *points,
+                                                        guint                  n_points,
+                                                        guint32                color);
+
+/* Функция создаёт пустой список команд рисования. */
+cairo_sdline_commands *cairo_sdline_commands_new       (void);
+
+/* Функция удаляет список команд рисования. */
+void                   cairo_sdline_commands_free      (cairo_sdline_commands *commands);
+
+/* Функция удаляет все команды из списка. */
+void                   cairo_sdline_commands_clear     (cairo_sdline_commands *commands);
+
+/* Функция возвращает число примитивов в списке команд, каждый маркер считается отдельно. */
+guint                  cairo_sdline_commands_get_n_primitives (cairo_sdline_commands *commands);
+
+/* Функция включает (commands != NULL) или отключает запись команд рисования. Пока
+   запись включена, примитивы не рисуют, а добавляют команды в список. Маркеры,
+   использованные при записи, должны существовать до воспроизведения команд. */
+void                   cairo_sdline_surface_set_recording (cairo_sdline_surface *surface,
+                                                        cairo_sdline_commands *commands);
+
+/* Функция воспроизводит команды рисования на поверхности. Поверхность делится
+   на n_threads горизонтальных полос, каждая из которых рисуется в отдельном потоке.
+   Если n_threads равно нулю, используются все процессоры системы. Результат
+   не зависит от числа потоков. */
+void                   cairo_sdline_commands_replay    (cairo_sdline_surface  *surface,
+                                                        cairo_sdline_commands *commands,
+                                                        guint                  n_threads);
+
+/* Функция воспроизводит команды рисования на поверхности со смещением всех
+   примитивов на dx, dy точек. Очистка поверхности не смещается. */
+void                   cairo_sdline_commands_replay_offset (cairo_sdline_surface *surface,
+                                                        cairo_sdline_commands *commands,
+                                                        gint32                 dx,
+                                                        gint32                 dy,
+                                                        guint                  n_threads);
+
 G_END_DECLS
 
 #endif /* __CAIRO_SDLINE_H__ */
@@ -0,0 +1,95 @@
+/*
+ * GtkCifroArea - 2D layers image management library.
+ *
+ * Copyright 2013-2017 Andrei Fadeev (andrei@webcontrol.ru)
+ *
+ * This file is part of GtkCifroArea.
+ *
+ * GtkCifroArea is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GtkCifroArea is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the author in this case.
+ *
+ */
+
+/*
+ * \file cifro-area-trace.h
+ *
+ * \brief Заголовочный файл точек трассировки формирования изображения
+ * \author Andrei Fadeev
+ * \date 2013-2017
+ * \license GNU General Public License version 3 или более поздняя<br>
+ * Коммерческая лицензия - свяжитесь с автором
+ *
+ * Точки трассировки отмечают начало и конец этапов формирования изображения.
+ * При сборке с опцией CIFRO_AREA_WITH_SYSPROF этап записывается в профиль sysprof
+ * как метка группы "GtkCifroArea" с длительностью этапа. При сборке с опцией
+ * CIFRO_AREA_WITH_USDT в начале и конце этапа устанавливаются статические пробы
+ * провайдера gtkcifroarea с именами <этап>__begin и <этап>__end, например для
+ * bpftrace: usdt:libgtkcifroarea-3.1.so:gtkcifroarea:visible_draw__end. Без этих
+ * опций точки трассировки не порождают кода.
+ *
+ * CIFRO_AREA_TRACE_BEGIN объявляет переменную, поэтому должен располагаться
+ * в том же блоке, что и парный ему CIFRO_AREA_TRACE_END. Аргумент arg
+ * CIFRO_AREA_TRACE_END - целое число, уточняющее этап (идентификатор канала,
+ * число значений и т.п.).
+ *
+ */
+
+#ifndef __CIFRO_AREA_TRACE_H__
+#define __CIFRO_AREA_TRACE_H__
+
+#include <glib.h>
+
+#ifdef CIFRO_AREA_WITH_SYSPROF
+#include <sysprof-capture.h>
+#endif
+
+#ifdef CIFRO_AREA_WITH_USDT
+#include <sys/sdt.h>
+#endif
+
+#ifdef CIFRO_AREA_WITH_SYSPROF
+#define CIFRO_AREA_TRACE_SYSPROF_BEGIN(name) \
+  gint64 cifro_area_trace_##name = SYSPROF_CAPTURE_CURRENT_TIME
+#define CIFRO_AREA_TRACE_SYSPROF_END(name, arg) \
+  sysprof_collector_mark_printf (cifro_area_trace_##name, \
+                                 SYSPROF_CAPTURE_CURRENT_TIME - cifro_area_trace_##name, \
+                                 "GtkCifroArea", #name, "%" G_GINT64_FORMAT, (gint64) (arg))
+#else
+#define CIFRO_AREA_TRACE_SYSPROF_BEGIN(name)
+#define CIFRO_AREA_TRACE_SYSPROF_END(name, arg)
+#endif
+
+#ifdef CIFRO_AREA_WITH_USDT
+#define CIFRO_AREA_TRACE_USDT_BEGIN(name) \
+  DTRACE_PROBE (gtkcifroarea, name##__begin)
+#define CIFRO_AREA_TRACE_USDT_END(name, arg) \
+  DTRACE_PROBE1 (gtkcifroarea, name##__end, (gint64) (arg))
+#else
+#define CIFRO_AREA_TRACE_USDT_BEGIN(name)
+#define CIFRO_AREA_TRACE_USDT_END(name, arg)
+#endif
+
+/* Начало этапа name. */
+#define CIFRO_AREA_TRACE_BEGIN(name) \
+  CIFRO_AREA_TRACE_SYSPROF_BEGIN (name); \
+  CIFRO_AREA_TRACE_USDT_BEGIN (name)
+
+/* Конец этапа name. */
+#define CIFRO_AREA_TRACE_END(name, arg) \
+  CIFRO_AREA_TRACE_SYSPROF_END (name, arg); \
+  CIFRO_AREA_TRACE_USDT_END (name, arg)
+
+#endif /* __CIFRO_AREA_TRACE_H__ */
@@ -0,0 +1,681 @@
+/*
+ * GtkCifroArea - 2D layers image management library.
+ *
+ * Copyright 2013-2017 Andrei Fadeev (andrei@webcontrol.ru)
+ *
+ * This file is part of GtkCifroArea.
+ *
+ * GtkCifroArea is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GtkCifroArea is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the author in this case.
+ *
+ */
+
+/*
+ * \file cifro-scope-data.c
+ *
+ * \brief Исходный файл функций поиска в массивах данных осциллографа
+ * \author Andrei Fadeev
+ * \date 2013-2017
+ * \license GNU General Public License version 3 или более поздняя<br>
+ * Коммерческая лицензия - свяжитесь с автором
+ *
+ */
+
+#include "cifro-scope-data.h"
+
+#include <math.h>
+
+/* Функция проверяет значение на соответствие условию поиска. */
+static inline gboolean
+_test (gfloat                     value,
+       cifro_scope_data_predicate predicate,
+       gfloat                     level1,
+       gfloat                     level2)
+{
+  switch (predicate)
+    {
+    case CIFRO_SCOPE_DATA_ABOVE:
+      return value > level1;
+    case CIFRO_SCOPE_DATA_BELOW:
+      return value < level1;
+    case CIFRO_SCOPE_DATA_INSIDE:
+      return (value >= level1) && (value <= level2);
+    case CIFRO_SCOPE_DATA_OUTSIDE:
+      return (value < level1) || (value > level2);
+    case CIFRO_SCOPE_DATA_NOT_ABOVE:
+      return value <= level1;
+    case CIFRO_SCOPE_DATA_NOT_BELOW:
+      return value >= level1;
+    case CIFRO_SCOPE_DATA_NAN:
+      return isnan (value);
+    case CIFRO_SCOPE_DATA_NUMBER:
+      return !isnan (value);
+    }
+
+  return FALSE;
+}
+
+/* Функция проверяет может ли блок с указанными минимальным и максимальным
+   значениями содержать значение, удовлетворяющее условию поиска. */
+static inline gboolean
+_candidate (gfloat                     min,
+            gfloat                     max,
+            gboolean                   has_nan,
+            cifro_scope_data_predicate predicate,
+            gfloat                     level1,
+            gfloat                     level2)
+{
+  switch (predicate)
+    {
+    case CIFRO_SCOPE_DATA_ABOVE:
+      return max > level1;
+    case CIFRO_SCOPE_DATA_BELOW:
+      return min < level1;
+    case CIFRO_SCOPE_DATA_INSIDE:
+      return (max >= level1) && (min <= level2);
+    case CIFRO_SCOPE_DATA_OUTSIDE:
+      return (min < level1) || (max > level2);
+    case CIFRO_SCOPE_DATA_NOT_ABOVE:
+      return min <= level1;
+    case CIFRO_SCOPE_DATA_NOT_BELOW:
+      return max >= level1;
+    case CIFRO_SCOPE_DATA_NAN:
+      return has_nan;
+    case CIFRO_SCOPE_DATA_NUMBER:
+      return min <= max;
+    }
+
+  return FALSE;
+}
+
+/* Функция добавляет сводные данные блока к результату. */
+static inline void
+_merge (cifro_scope_data_block       *range,
+        const cifro_scope_data_block *block)
+{
+  range->min = MIN (range->min, block->min);
+  range->max = MAX (range->max, block->max);
+  range->n_nan += block->n_nan;
+  range->sum += block->sum;
+  range->sum2 += block->sum2;
+}
+
+/* Функция рекурсивно вычисляет сводные данные для пересечения блока с диапазоном [from, to). */
+static void
+_range_node (cifro_scope_data_summary *summary,
+             const gfloat             *data,
+             guint                     level,
+             gint64                    node,
+             gint64                    node_size,
+             gint64                    from,
+             gint64                    to,
+             cifro_scope_data_block   *range)
+{
+  gint64 begin = node * node_size;
+  gint64 end = MIN (summary->n_values, begin + node_size);
+  gint64 child;
+  gint64 i;
+
+  if ((end <= from) || (begin >= to))
+    return;
+
+  if ((begin >= from) && (end <= to))
+    {
+      _merge (range, &summary->blocks[level][node]);
+      return;
+    }
+
+  if (level == 0)
+    {
+      for (i = MAX (begin, from); i < MIN (end, to); i++)
+        {
+          if (isnan (data[i]))
+            {
+              range->n_nan += 1;
+              continue;
+            }
+          range->min = MIN (range->min, data[i]);
+          range->max = MAX (range->max, data[i]);
+          range->sum += data[i];
+          range->sum2 += (gdouble) data[i] * data[i];
+        }
+      return;
+    }
+
+  for (child = node * CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+       child < MIN (summary->n_blocks[level - 1], (node + 1) * CIFRO_SCOPE_DATA_SUMMARY_FANOUT);
+       child++)
+    {
+      _range_node (summary, data, level - 1, child, node_size / CIFRO_SCOPE_DATA_SUMMARY_FANOUT,
+                   from, to, range);
+    }
+}
+
+/* Функция рекурсивно подсчитывает пересечения уровня в блоке. Блоки, значения которых
+   целиком лежат по одну сторону от уровня или порогов гистерезиса, учитываются без
+   просмотра значений. Состояние: -1 - значение ниже порога, 1 - выше, 0 - неизвестно. */
+static void
+_crossings_node (cifro_scope_data_summary   *summary,
+                 const gfloat               *data,
+                 guint                       level,
+                 gint64                      node,
+                 gint64                      node_size,
+                 gint64                      from,
+                 gint64                      to,
+                 gfloat                      level_value,
+                 gfloat                      low,
+                 gfloat                      high,
+                 gint                       *state,
+                 cifro_scope_data_crossings *crossings)
+{
+  cifro_scope_data_block *block = &summary->blocks[level][node];
+  gint64 begin = node * node_size;
+  gint64 end = MIN (summary->n_values, begin + node_size);
+  gint64 count;
+  gint64 child;
+  gint64 i;
+
+  if ((end <= from) || (begin >= to))
+    return;
+
+  if ((begin >= from) && (end <= to))
+    {
+      count = (end - begin) - block->n_nan;
+      if (count == 0)
+        return;
+
+      /* Все значения выше верхнего порога, момент пересечения известен
+         только если в блоке нет NaN. */
+      if ((block->min > high) && ((*state != -1) || (block->n_nan == 0)))
+        {
+          if (*state == -1)
+            {
+              if (crossings->n_rising == 0)
+                crossings->first_rising = begin;
+              crossings->last_rising = begin;
+              crossings->n_rising += 1;
+            }
+          crossings->n_above += count;
+          *state = 1;
+          return;
+        }
+
+      /* Все значения ниже нижнего порога. */
+      if (block->max < low)
+        {
+          *state = -1;
+          return;
+        }
+
+      /* Все значения между порогами по одну сторону от уровня. */
+      if ((block->min >= low) && (block->max <= level_value))
+        return;
+
+      if ((block->min > level_value) && (block->max <= high))
+        {
+          crossings->n_above += count;
+          return;
+        }
+    }
+
+  if (level == 0)
+    {
+      for (i = MAX (begin, from); i < MIN (end, to); i++)
+        {
+          gfloat value = data[i];
+
+          if (isnan (value))
+            continue;
+
+          if (value > level_value)
+            crossings->n_above += 1;
+
+          if (value > high)
+            {
+              if (*state == -1)
+                {
+                  if (crossings->n_rising == 0)
+                    crossings->first_rising = i;
+                  crossings->last_rising = i;
+                  crossings->n_rising += 1;
+                }
+              *state = 1;
+            }
+          else if (value < low)
+            {
+              *state = -1;
+            }
+        }
+      return;
+    }
+
+  for (child = node * CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+       child < MIN (summary->n_blocks[level - 1], (node + 1) * CIFRO_SCOPE_DATA_SUMMARY_FANOUT);
+       child++)
+    {
+      _crossings_node (summary, data, level - 1, child, node_size / CIFRO_SCOPE_DATA_SUMMARY_FANOUT,
+                       from, to, level_value, low, high, state, crossings);
+    }
+}
+
+/* Функция вычисляет минимальное и максимальное значения в массиве, значения NaN пропускаются. */
+void
+cifro_scope_data_minmax (const gfloat *data,
+                         gint64        n_values,
+                         gfloat       *min,
+                         gfloat       *max)
+{
+  gfloat cur_min = G_MAXFLOAT;
+  gfloat cur_max = -G_MAXFLOAT;
+  gint64 i;
+
+  /* Цикл записан без ветвлений, чтобы компилятор мог векторизовать его.
+     Сравнения с NaN всегда ложны, поэтому такие значения пропускаются. */
+  for (i = 0; i < n_values; i++)
+    {
+      gfloat value = data[i];
+      cur_min = (value < cur_min) ? value : cur_min;
+      cur_max = (value > cur_max) ? value : cur_max;
+    }
+
+  *min = cur_min;
+  *max = cur_max;
+}
+
+/* Функция ищет первое значение в диапазоне индексов [from, to), удовлетворяющее условию. */
+gint64
+cifro_scope_data_find (const gfloat               *data,
+                       gint64                      from,
+                       gint64                      to,
+                       cifro_scope_data_predicate  predicate,
+                       gfloat                      level1,
+                       gfloat                      level2)
+{
+  gint64 block_end;
+  gint64 i;
+  gfloat min;
+  gfloat max;
+
+  if (from < 0)
+    from = 0;
+
+  i = from;
+  while (i < to)
+    {
+      block_end = MIN (to, (i / CIFRO_SCOPE_DATA_BLOCK_SIZE + 1) * CIFRO_SCOPE_DATA_BLOCK_SIZE);
+
+      /* Целые блоки, в которых заведомо нет нужных значений, пропускаем. */
+      if ((i % CIFRO_SCOPE_DATA_BLOCK_SIZE) == 0)
+        {
+          cifro_scope_data_minmax (data + i, block_end - i, &min, &max);
+          if (!_candidate (min, max, TRUE, predicate, level1, level2))
+            {
+              i = block_end;
+              continue;
+            }
+        }
+
+      for (; i < block_end; i++)
+        if (_test (data[i], predicate, level1, level2))
+          return i;
+    }
+
+  return -1;
+}
+
+/* Функция вычисляет блок нижнего уровня иерархии по исходным данным. */
+static void
+_build_leaf (cifro_scope_data_summary *summary,
+             const gfloat             *data,
+             gint64                    node)
+{
+  cifro_scope_data_block *block = &summary->blocks[0][node];
+  gint64 begin = node * CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+  gint64 end = MIN (summary->n_values, begin + CIFRO_SCOPE_DATA_SUMMARY_BLOCK);
+  guint32 n_nan = 0;
+  gdouble sum = 0.0;
+  gdouble sum2 = 0.0;
+  gint64 i;
+
+  cifro_scope_data_minmax (data + begin, end - begin, &block->min, &block->max);
+
+  for (i = begin; i < end; i++)
+    {
+      if (isnan (data[i]))
+        {
+          n_nan += 1;
+          continue;
+        }
+      sum += data[i];
+      sum2 += (gdouble) data[i] * data[i];
+    }
+
+  block->n_nan = n_nan;
+  block->sum = sum;
+  block->sum2 = sum2;
+}
+
+/* Функция вычисляет блок верхнего уровня иерархии по блокам нижележащего уровня. */
+static void
+_build_node (cifro_scope_data_summary *summary,
+             guint                     level,
+             gint64                    node)
+{
+  cifro_scope_data_block *block = &summary->blocks[level][node];
+  cifro_scope_data_block *child;
+  gint64 i;
+
+  block->min = G_MAXFLOAT;
+  block->max = -G_MAXFLOAT;
+  block->n_nan = 0;
+  block->sum = 0.0;
+  block->sum2 = 0.0;
+
+  for (i = node * CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+       i < MIN (summary->n_blocks[level - 1], (node + 1) * CIFRO_SCOPE_DATA_SUMMARY_FANOUT);
+       i++)
+    {
+      child = &summary->blocks[level - 1][i];
+      block->min = MIN (block->min, child->min);
+      block->max = MAX (block->max, child->max);
+      block->n_nan += child->n_nan;
+      block->sum += child->sum;
+      block->sum2 += child->sum2;
+    }
+}
+
+/* Функция создаёт иерархию сводных данных для массива значений. */
+cifro_scope_data_summary *
+cifro_scope_data_summary_new (const gfloat *data,
+                              gint64        n_values)
+{
+  cifro_scope_data_summary *summary;
+  gint64 n_blocks;
+  guint level;
+
+  summary = g_new0 (cifro_scope_data_summary, 1);
+  summary->n_values = n_values;
+
+  /* Число уровней иерархии: на верхнем уровне находится один блок. */
+  n_blocks = (n_values + CIFRO_SCOPE_DATA_SUMMARY_BLOCK - 1) / CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+  summary->n_levels = 1;
+  while (n_blocks > 1)
+    {
+      n_blocks = (n_blocks + CIFRO_SCOPE_DATA_SUMMARY_FANOUT - 1) / CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+      summary->n_levels += 1;
+    }
+
+  summary->n_blocks = g_new (gint64, summary->n_levels);
+  summary->blocks = g_new (cifro_scope_data_block*, summary->n_levels);
+
+  /* Нижний уровень строится по исходным данным. */
+  n_blocks = (n_values + CIFRO_SCOPE_DATA_SUMMARY_BLOCK - 1) / CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+  summary->n_blocks[0] = n_blocks;
+  summary->blocks[0] = g_new (cifro_scope_data_block, MAX (n_blocks, 1));
+
+  /* Верхние уровни строятся по блокам нижележащего уровня. */
+  for (level = 1; level < summary->n_levels; level++)
+    {
+      n_blocks = (summary->n_blocks[level - 1] + CIFRO_SCOPE_DATA_SUMMARY_FANOUT - 1) / CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+      summary->n_blocks[level] = n_blocks;
+      summary->blocks[level] = g_new (cifro_scope_data_block, n_blocks);
+    }
+
+  cifro_scope_data_summary_update (summary, data, 0, n_values);
+
+  return summary;
+}
+
+/* Функция обновляет сводные данные после изменения значений с индексами [from, to).
+   Пересчитываются только блоки, содержащие изменённые значения, и их родители. */
+void
+cifro_scope_data_summary_update (cifro_scope_data_summary *summary,
+                                 const gfloat             *data,
+                                 gint64                    from,
+                                 gint64                    to)
+{
+  gint64 first, last;
+  gint64 i;
+  guint level;
+
+  from = MAX (from, 0);
+  to = MIN (to, summary->n_values);
+  if (from >= to)
+    return;
+
+  first = from / CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+  last = (to - 1) / CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+  for (i = first; i <= last; i++)
+    _build_leaf (summary, data, i);
+
+  for (level = 1; level < summary->n_levels; level++)
+    {
+      first /= CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+      last /= CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+      for (i = first; i <= last; i++)
+        _build_node (summary, level, i);
+    }
+}
+
+/* Функция удаляет иерархию сводных данных. */
+void
+cifro_scope_data_summary_free (cifro_scope_data_summary *summary)
+{
+  guint level;
+
+  if (summary == NULL)
+    return;
+
+  for (level = 0; level < summary->n_levels; level++)
+    g_free (summary->blocks[level]);
+
+  g_free (summary->blocks);
+  g_free (summary->n_blocks);
+  g_free (summary);
+}
+
+/* Функция ищет первое значение, удовлетворяющее условию, начиная с индекса from
+   в сторону увеличения (forward = TRUE) или уменьшения индексов. */
+gint64
+cifro_scope_data_summary_find (cifro_scope_data_summary   *summary,
+                               const gfloat               *data,
+                               gint64                      from,
+                               gboolean                    forward,
+                               cifro_scope_data_predicate  predicate,
+                               gfloat                      level1,
+                               gfloat                      level2)
+{
+  cifro_scope_data_block *block;
+  gint64 n_values = summary->n_values;
+  gint64 block_begin;
+  gint64 block_end;
+  gint64 block_size;
+  gint64 node;
+  gint64 i;
+  guint level;
+
+#define BLOCK_CANDIDATE(b) _candidate ((b)->min, (b)->max, (b)->n_nan > 0, predicate, level1, level2)
+
+  if (forward)
+    {
+      i = MAX (from, 0);
+      while (i < n_values)
+        {
+          node = i / CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+          block_begin = node * CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+          block_end = MIN (n_values, block_begin + CIFRO_SCOPE_DATA_SUMMARY_BLOCK);
+
+          /* Поиск начинается с середины блока - проверяем его остаток. */
+          if (i != block_begin)
+            {
+              if (BLOCK_CANDIDATE (&summary->blocks[0][node]))
+                {
+                  gint64 found = cifro_scope_data_find (data, i, block_end, predicate, level1, level2);
+                  if (found >= 0)
+                    return found;
+                }
+              i = block_end;
+              continue;
+            }
+
+          /* Поднимаемся до самого большого блока, начинающегося с текущего индекса. */
+          level = 0;
+          block_size = CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+          while ((level + 1 < summary->n_levels) && ((node % CIFRO_SCOPE_DATA_SUMMARY_FANOUT) == 0))
+            {
+              node /= CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+              block_size *= CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+              level += 1;
+            }
+
+          /* Спускаемся пока блок может содержать искомое значение. */
+          block = &summary->blocks[level][node];
+          while ((level > 0) && BLOCK_CANDIDATE (block))
+            {
+              node *= CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+              block_size /= CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+              level -= 1;
+              block = &summary->blocks[level][node];
+            }
+
+          if (BLOCK_CANDIDATE (block))
+            {
+              gint64 found = cifro_scope_data_find (data, i, block_end, predicate, level1, level2);
+              if (found >= 0)
+                return found;
+            }
+
+          i = (node + 1) * block_size;
+        }
+    }
+  else
+    {
+      i = MIN (from, n_values - 1);
+      while (i >= 0)
+        {
+          node = i / CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+          block_begin = node * CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+          block_end = MIN (n_values, block_begin + CIFRO_SCOPE_DATA_SUMMARY_BLOCK);
+
+          /* Поиск начинается не с конца блока - проверяем его начало,
+             иначе поднимаемся до самого большого блока, заканчивающегося текущим индексом. */
+          if (i == block_end - 1)
+            {
+              level = 0;
+              block_size = CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+              while ((level + 1 < summary->n_levels) &&
+                     (((node % CIFRO_SCOPE_DATA_SUMMARY_FANOUT) == (CIFRO_SCOPE_DATA_SUMMARY_FANOUT - 1)) ||
+                      (node == summary->n_blocks[level] - 1)))
+                {
+                  node /= CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+                  block_size *= CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+                  level += 1;
+                }
+
+              block = &summary->blocks[level][node];
+              while ((level > 0) && BLOCK_CANDIDATE (block))
+                {
+                  node = MIN (node * CIFRO_SCOPE_DATA_SUMMARY_FANOUT + CIFRO_SCOPE_DATA_SUMMARY_FANOUT - 1,
+                              summary->n_blocks[level - 1] - 1);
+                  block_size /= CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+                  level -= 1;
+                  block = &summary->blocks[level][node];
+                }
+
+              if (!BLOCK_CANDIDATE (block))
+                {
+                  i = node * block_size - 1;
+                  continue;
+                }
+
+              block_begin = node * CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+            }
+          else if (!BLOCK_CANDIDATE (&summary->blocks[0][node]))
+            {
+              i = block_begin - 1;
+              continue;
+            }
+
+          for (; i >= block_begin; i--)
+            if (_test (data[i], predicate, level1, level2))
+              return i;
+        }
+    }
+
+#undef BLOCK_CANDIDATE
+
+  return -1;
+}
+
+/* Функция вычисляет размер блока верхнего уровня иерархии в значениях. */
+static gint64
+_root_size (cifro_scope_data_summary *summary)
+{
+  gint64 node_size = CIFRO_SCOPE_DATA_SUMMARY_BLOCK;
+  guint level;
+
+  for (level = 1; level < summary->n_levels; level++)
+    node_size *= CIFRO_SCOPE_DATA_SUMMARY_FANOUT;
+
+  return node_size;
+}
+
+/* Функция вычисляет сводные данные для диапазона индексов [from, to). */
+void
+cifro_scope_data_summary_range (cifro_scope_data_summary *summary,
+                                const gfloat             *data,
+                                gint64                    from,
+                                gint64                    to,
+                                cifro_scope_data_block   *range)
+{
+  range->min = G_MAXFLOAT;
+  range->max = -G_MAXFLOAT;
+  range->n_nan = 0;
+  range->sum = 0.0;
+  range->sum2 = 0.0;
+
+  if ((summary->n_values == 0) || (from >= to))
+    return;
+
+  _range_node (summary, data, summary->n_levels - 1, 0, _root_size (summary),
+               MAX (from, 0), MIN (to, summary->n_values), range);
+}
+
+/* Функция подсчитывает значения больше уровня и пересечения уровня снизу вверх
+   с гистерезисом в диапазоне индексов [from, to). */
+void
+cifro_scope_data_summary_crossings (cifro_scope_data_summary   *summary,
+                                    const gfloat               *data,
+                                    gint64                      from,
+                                    gint64                      to,
+                                    gfloat                      level,
+                                    gfloat                      hysteresis,
+                                    cifro_scope_data_crossings *crossings)
+{
+  gint state = 0;
+
+  crossings->n_above = 0;
+  crossings->n_rising = 0;
+  crossings->first_rising = -1;
+  crossings->last_rising = -1;
+
+  if ((summary->n_values == 0) || (from >= to))
+    return;
+
+  _crossings_node (summary, data, summary->n_levels - 1, 0, _root_size (summary),
+                   MAX (from, 0), MIN (to, summary->n_values),
+                   level, level - hysteresis, level + hysteresis, &state, crossings);
+}
@@ -0,0 +1,150 @@
+/*
+ * GtkCifroArea - 2D layers image management library.
+ *
+ * Copyright 2013-2017 Andrei Fadeev (andrei@webcontrol.ru)
+ *
+ * This file is part of GtkCifroArea.
+ *
+ * GtkCifroArea is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GtkCifroArea is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the author in this case.
+ *
+ */
+
+/*
+ * \file cifro-scope-data.h
+ *
+ * \brief Заголовочный файл функций поиска в массивах данных осциллографа
+ * \author Andrei Fadeev
+ * \date 2013-2017
+ * \license GNU General Public License version 3 или более поздняя<br>
+ * Коммерческая лицензия - свяжитесь с автором
+ *
+ */
+
+#ifndef __CIFRO_SCOPE_DATA_H__
+#define __CIFRO_SCOPE_DATA_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Число значений в одном блоке данных. */
+#define CIFRO_SCOPE_DATA_BLOCK_SIZE    64
+
+/* Число значений в блоке нижнего уровня сводных данных. */
+#define CIFRO_SCOPE_DATA_SUMMARY_BLOCK 256
+
+/* Число дочерних блоков у блока сводных данных. */
+#define CIFRO_SCOPE_DATA_SUMMARY_FANOUT 4
+
+/* Условия поиска значений. */
+typedef enum
+{
+  CIFRO_SCOPE_DATA_ABOVE,                      /* Значение больше level1. */
+  CIFRO_SCOPE_DATA_BELOW,                      /* Значение меньше level1. */
+  CIFRO_SCOPE_DATA_INSIDE,                     /* Значение в диапазоне от level1 до level2 включительно. */
+  CIFRO_SCOPE_DATA_OUTSIDE,                    /* Значение вне диапазона от level1 до level2. */
+  CIFRO_SCOPE_DATA_NOT_ABOVE,                  /* Значение меньше или равно level1. */
+  CIFRO_SCOPE_DATA_NOT_BELOW,                  /* Значение больше или равно level1. */
+  CIFRO_SCOPE_DATA_NAN,                        /* Значение NaN. */
+  CIFRO_SCOPE_DATA_NUMBER                      /* Значение не NaN. */
+} cifro_scope_data_predicate;
+
+/* Сводные данные блока значений. */
+typedef struct
+{
+  gfloat               min;                    /* Минимальное значение в блоке. */
+  gfloat               max;                    /* Максимальное значение в блоке. */
+  guint32              n_nan;                  /* Число значений NaN в блоке. */
+  gdouble              sum;                    /* Сумма значений в блоке. */
+  gdouble              sum2;                   /* Сумма квадратов значений в блоке. */
+} cifro_scope_data_block;
+
+/* Результаты подсчёта пересечений уровня. */
+typedef struct
+{
+  gint64               n_above;                /* Число значений больше уровня. */
+  gint64               n_rising;               /* Число пересечений уровня снизу вверх. */
+  gint64               first_rising;           /* Индекс первого пересечения уровня снизу вверх. */
+  gint64               last_rising;            /* Индекс последнего пересечения уровня снизу вверх. */
+} cifro_scope_data_crossings;
+
+/* Иерархия сводных данных массива значений. */
+typedef struct
+{
+  gint64               n_values;               /* Число значений в массиве. */
+  guint                n_levels;               /* Число уровней иерархии. */
+  gint64              *n_blocks;               /* Число блоков на каждом уровне. */
+  cifro_scope_data_block **blocks;             /* Блоки каждого уровня. */
+} cifro_scope_data_summary;
+
+/* Функция вычисляет минимальное и максимальное значения в массиве, значения NaN пропускаются. */
+void                   cifro_scope_data_minmax         (const gfloat                 *data,
+                                                        gint64                        n_values,
+                                                        gfloat                       *min,
+                                                        gfloat                       *max);
+
+/* Функция ищет первое значение в диапазоне индексов [from, to), удовлетворяющее условию. */
+gint64                 cifro_scope_data_find           (const gfloat                 *data,
+                                                        gint64                        from,
+                                                        gint64                        to,
+                                                        cifro_scope_data_predicate    predicate,
+                                                        gfloat                        level1,
+                                                        gfloat                        level2);
+
+/* Функция создаёт иерархию сводных данных для массива значений. */
+cifro_scope_data_summary *cifro_scope_data_summary_new (const gfloat                 *data,
+                                                        gint64                        n_values);
+
+/* Функция удаляет иерархию сводных данных. */
+void                   cifro_scope_data_summary_free   (cifro_scope_data_summary     *summary);
+
+/* Функция обновляет сводные данные после изменения значений с индексами [from, to). */
+void                   cifro_scope_data_summary_update (cifro_scope_data_summary     *summary,
+                                                        const gfloat                 *data,
+                                                        gint64                        from,
+                                                        gint64                        to);
+
+/* Функция ищет первое значение, удовлетворяющее условию, начиная с индекса from
+   в сторону увеличения (forward = TRUE) или уменьшения индексов. */
+gint64                 cifro_scope_data_summary_find   (cifro_scope_data_summary     *summary,
+                                                        const gfloat                 *data,
+                                                        gint64                        from,
+                                                        gboolean                      forward,
+                                                        cifro_scope_data_predicate    predicate,
+                                                        gfloat                        level1,
+                                                        gfloat                        level2);
+
+/* Функция вычисляет сводные данные для диапазона индексов [from, to). */
+void                   cifro_scope_data_summary_range  (cifro_scope_data_summary     *summary,
+                                                        const gfloat                 *data,
+                                                        gint64                        from,
+                                                        gint64                        to,
+                                                        cifro_scope_data_block       *range);
+
+/* Функция подсчитывает значения больше уровня и пересечения уровня снизу вверх
+   с гистерезисом в диапазоне индексов [from, to). */
+void                   cifro_scope_data_summary_crossings (cifro_scope_data_summary  *summary,
+                                                        const gfloat                 *data,
+                                                        gint64                        from,
+                                                        gint64                        to,
+                                                        gfloat                        level,
+                                                        gfloat                        hysteresis,
+                                                        cifro_scope_data_crossings   *crossings);
+
+G_END_DECLS
+
+#endif /* __CIFRO_SCOPE_DATA_H__ */
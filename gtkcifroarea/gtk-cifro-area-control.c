@@ -40,6 +40,11 @@
 #include <string.h>
 #include <math.h>
 
+#define ANIMATION_DURATION     150             /* Длительность анимации изменения вида, мс. */
+#define FLING_MAX_DELAY        50              /* Максимальная пауза перед отпусканием для инерции, мс. */
+#define VELOCITY_SMOOTHING     0.8             /* Вес нового значения при сглаживании скорости. */
+#define SCROLL_ZOOM_BASE       1.1             /* Изменение масштаба за один шаг прокрутки. */
+
 enum
 {
   SCROLL_ACTION_NONE,
@@ -64,8 +69,32 @@ struct _GtkCifroAreaControlPrivate
   gdouble                start_to_y;           /* Начальная граница отображения по оси Y. */
   gint                   move_from_x;          /* Начальная координата перемещения. */
   gint                   move_from_y;          /* Начальная координата перемещения. */
+
+  gboolean               animation;            /* Признак анимации изменения вида. */
+  gboolean               view_animation;       /* Признак выполнения анимации изменения вида с клавиатуры. */
+  gdouble                target_from_x;        /* Конечная граница анимации по оси X. */
+  gdouble                target_to_x;          /* Конечная граница анимации по оси X. */
+  gdouble                target_from_y;        /* Конечная граница анимации по оси Y. */
+  gdouble                target_to_y;          /* Конечная граница анимации по оси Y. */
+
+  gdouble                last_x;               /* Последняя координата курсора при перемещении. */
+  gdouble                last_y;               /* Последняя координата курсора при перемещении. */
+  guint32                last_time;            /* Время последнего перемещения курсора, мс. */
+  gdouble                velocity_x;           /* Скорость перемещения по оси X, логические единицы в секунду. */
+  gdouble                velocity_y;           /* Скорость перемещения по оси Y, логические единицы в секунду. */
+
+  guint                  scroll_id;            /* Идентификатор обработчика накопленной прокрутки. */
+  gdouble                scroll_x;             /* Координата курсора при прокрутке. */
+  gdouble                scroll_y;             /* Координата курсора при прокрутке. */
+  gdouble                scroll_zoom_x;        /* Накопленное число шагов масштабирования по оси X. */
+  gdouble                scroll_zoom_y;        /* Накопленное число шагов масштабирования по оси Y. */
+  gdouble                scroll_move_x;        /* Накопленное перемещение по оси X, точки экрана. */
+  gdouble                scroll_move_y;        /* Накопленное перемещение по оси Y, точки экрана. */
+  gdouble                scroll_angle;         /* Накопленный угол поворота, радианы. */
 };
 
+static void      gtk_cifro_area_control_unrealize             (GtkWidget                     *widget);
+
 static gboolean  gtk_cifro_area_control_key_press             (GtkWidget                     *widget,
                                                                GdkEventKey                   *event);
 
@@ -80,6 +109,46 @@ static gboolean  gtk_cifro_area_control_scroll                (GtkWidget
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkCifroAreaControl, gtk_cifro_area_control, GTK_TYPE_CIFRO_AREA)
 
+/* Функция возвращает границы отображения перед их изменением. Если выполняется анимация
+   изменения вида с клавиатуры, изменение отсчитывается от её конечных границ. */
+static void
+gtk_cifro_area_control_begin_view (GtkCifroAreaControl *control,
+                                   gdouble             *view)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (control);
+  GtkCifroAreaControlPrivate *priv = control->priv;
+
+  gtk_cifro_area_get_view (carea, &view[0], &view[1], &view[2], &view[3]);
+
+  if (priv->animation && priv->view_animation && gtk_cifro_area_get_animating (carea))
+    {
+      gtk_cifro_area_set_view (carea, priv->target_from_x, priv->target_to_x,
+                                      priv->target_from_y, priv->target_to_y);
+    }
+}
+
+/* Функция запускает анимацию от границ отображения view к установленным после изменения. */
+static void
+gtk_cifro_area_control_end_view (GtkCifroAreaControl *control,
+                                 const gdouble       *view)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (control);
+  GtkCifroAreaControlPrivate *priv = control->priv;
+
+  if (!priv->animation)
+    return;
+
+  gtk_cifro_area_get_view (carea, &priv->target_from_x, &priv->target_to_x,
+                                  &priv->target_from_y, &priv->target_to_y);
+
+  gtk_cifro_area_set_view (carea, view[0], view[1], view[2], view[3]);
+  gtk_cifro_area_animate_view (carea, priv->target_from_x, priv->target_to_x,
+                                      priv->target_from_y, priv->target_to_y,
+                                      ANIMATION_DURATION);
+
+  priv->view_animation = TRUE;
+}
+
 static void
 gtk_cifro_area_control_init (GtkCifroAreaControl *control)
 {
@@ -89,6 +158,10 @@ gtk_cifro_area_control_init (GtkCifroAreaControl *control)
 
   priv->move_step = 1.0;
   priv->rotate_step = 1.0;
+
+#ifndef CIFRO_AREA_WITH_GTK2
+  gtk_widget_add_events (GTK_WIDGET (control), GDK_SMOOTH_SCROLL_MASK);
+#endif
 }
 
 static void
@@ -96,6 +169,7 @@ gtk_cifro_area_control_class_init (GtkCifroAreaControlClass *klass)
 {
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
+  widget_class->unrealize = gtk_cifro_area_control_unrealize;
   widget_class->key_press_event = gtk_cifro_area_control_key_press;
   widget_class->button_press_event = gtk_cifro_area_control_button_press_release;
   widget_class->button_release_event = gtk_cifro_area_control_button_press_release;
@@ -103,6 +177,107 @@ gtk_cifro_area_control_class_init (GtkCifroAreaControlClass *klass)
   widget_class->scroll_event = gtk_cifro_area_control_scroll;
 }
 
+/* Функция применяет накопленные события прокрутки одним изменением вида. */
+static void
+gtk_cifro_area_control_apply_scroll (GtkCifroAreaControl *control)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (control);
+  GtkCifroAreaControlPrivate *priv = control->priv;
+  gint step_x, step_y;
+
+  /* Масштабирование. Если наследуемый класс изменяет масштаб сам, накопленные
+     целые шаги применяются по одному через его обработчик, а дробная часть
+     сохраняется до следующего кадра. */
+  if (GTK_CIFRO_AREA_GET_CLASS (carea)->zoom != NULL)
+    {
+      gdouble val_x, val_y;
+
+      step_x = priv->scroll_zoom_x;
+      step_y = priv->scroll_zoom_y;
+      priv->scroll_zoom_x -= step_x;
+      priv->scroll_zoom_y -= step_y;
+
+      if ((step_x != 0) || (step_y != 0))
+        gtk_cifro_area_point_to_value (carea, priv->scroll_x, priv->scroll_y, &val_x, &val_y);
+
+      while ((step_x != 0) || (step_y != 0))
+        {
+          gtk_cifro_area_zoom (carea,
+                               (step_x < 0) ? GTK_CIFRO_AREA_ZOOM_IN :
+                               (step_x > 0) ? GTK_CIFRO_AREA_ZOOM_OUT : GTK_CIFRO_AREA_ZOOM_NONE,
+                               (step_y < 0) ? GTK_CIFRO_AREA_ZOOM_IN :
+                               (step_y > 0) ? GTK_CIFRO_AREA_ZOOM_OUT : GTK_CIFRO_AREA_ZOOM_NONE,
+                               val_x, val_y);
+
+          step_x -= (step_x > 0) - (step_x < 0);
+          step_y -= (step_y > 0) - (step_y < 0);
+        }
+    }
+  else if ((priv->scroll_zoom_x != 0.0) || (priv->scroll_zoom_y != 0.0))
+    {
+      gdouble val_x, val_y;
+
+      gtk_cifro_area_point_to_value (carea, priv->scroll_x, priv->scroll_y, &val_x, &val_y);
+      gtk_cifro_area_zoom_factor (carea, pow (SCROLL_ZOOM_BASE, priv->scroll_zoom_x),
+                                         pow (SCROLL_ZOOM_BASE, priv->scroll_zoom_y),
+                                         val_x, val_y);
+
+      priv->scroll_zoom_x = 0.0;
+      priv->scroll_zoom_y = 0.0;
+    }
+
+  /* Перемещение, дробная часть шага сохраняется до следующего кадра. */
+  step_x = priv->scroll_move_x;
+  step_y = priv->scroll_move_y;
+  if ((step_x != 0) || (step_y != 0))
+    gtk_cifro_area_move (carea, step_x, step_y);
+
+  /* Поворот. */
+  if (priv->scroll_angle != 0.0)
+    gtk_cifro_area_rotate (carea, priv->scroll_angle);
+
+  priv->scroll_move_x -= step_x;
+  priv->scroll_move_y -= step_y;
+  priv->scroll_angle = 0.0;
+
+  gtk_cifro_area_set_interacting (carea, FALSE);
+}
+
+#ifndef CIFRO_AREA_WITH_GTK2
+/* Функция применения накопленной прокрутки в начале кадра. */
+static gboolean
+gtk_cifro_area_control_scroll_tick (GtkWidget     *widget,
+                                    GdkFrameClock *clock,
+                                    gpointer       data)
+{
+  GtkCifroAreaControl *control = GTK_CIFRO_AREA_CONTROL (widget);
+
+  control->priv->scroll_id = 0;
+  gtk_cifro_area_control_apply_scroll (control);
+
+  return G_SOURCE_REMOVE;
+}
+#endif
+
+/* Обработчик удаления окна виджета. */
+static void
+gtk_cifro_area_control_unrealize (GtkWidget *widget)
+{
+  GtkCifroAreaControl *control = GTK_CIFRO_AREA_CONTROL (widget);
+  GtkCifroAreaControlPrivate *priv = control->priv;
+
+#ifndef CIFRO_AREA_WITH_GTK2
+  if (priv->scroll_id != 0)
+    {
+      gtk_widget_remove_tick_callback (widget, priv->scroll_id);
+      priv->scroll_id = 0;
+      gtk_cifro_area_control_apply_scroll (control);
+    }
+#endif
+
+  GTK_WIDGET_CLASS (gtk_cifro_area_control_parent_class)->unrealize (widget);
+}
+
 /* Обработчик нажатия кнопок клавиатуры. */
 static gboolean
 gtk_cifro_area_control_key_press (GtkWidget   *widget,
@@ -111,6 +286,7 @@ gtk_cifro_area_control_key_press (GtkWidget   *widget,
   GtkCifroArea *carea = GTK_CIFRO_AREA (widget);
   GtkCifroAreaControl *control = GTK_CIFRO_AREA_CONTROL (widget);
   GtkCifroAreaControlPrivate *priv = control->priv;
+  gdouble view[4];
 
   /* Перемещение области. */
   if (((event->keyval == GDK_KEY_Left) || (event->keyval == GDK_KEY_Right) ||
@@ -153,7 +329,9 @@ gtk_cifro_area_control_key_press (GtkWidget   *widget,
             step_y = -move_step;
         }
 
+      gtk_cifro_area_control_begin_view (control, view);
       gtk_cifro_area_move (carea, step_x, step_y);
+      gtk_cifro_area_control_end_view (control, view);
     }
 
   /* Перемещение области в начало или конец. */
@@ -166,6 +344,8 @@ gtk_cifro_area_control_key_press (GtkWidget   *widget,
       gdouble min_y, max_y;
       gdouble step;
 
+      gtk_cifro_area_control_begin_view (control, view);
+
       gtk_cifro_area_get_scale (carea, &scale_x, &scale_y);
       gtk_cifro_area_get_limits (carea, &min_x, &max_x, &min_y, &max_y);
 
@@ -193,6 +373,7 @@ gtk_cifro_area_control_key_press (GtkWidget   *widget,
         }
 
       gtk_cifro_area_move (carea, step_x, step_y);
+      gtk_cifro_area_control_end_view (control, view);
     }
 
   /* Поворот области. */
@@ -236,12 +417,14 @@ gtk_cifro_area_control_key_press (GtkWidget   *widget,
       if (event->state & GDK_MOD1_MASK)
         direction_x = GTK_CIFRO_AREA_ZOOM_NONE;
 
+      gtk_cifro_area_control_begin_view (control, view);
       gtk_cifro_area_get_view (carea, &from_x, &to_x, &from_y, &to_y);
 
       val_x = from_x + (to_x - from_x) / 2.0;
       val_y = from_y + (to_y - from_y) / 2.0;
 
       gtk_cifro_area_zoom (carea, direction_x, direction_y, val_x, val_y);
+      gtk_cifro_area_control_end_view (control, view);
     }
 
   return FALSE;
@@ -275,17 +458,36 @@ gtk_cifro_area_control_button_press_release (GtkWidget      *widget,
       if ((event->x > border_left) && (event->x < (border_left + clip_width)) &&
           (event->y > border_top) && (event->y < (border_top + clip_height)))
         {
+          gtk_cifro_area_stop_animation (carea);
+
           priv->move_area = TRUE;
           priv->move_from_x = event->x;
           priv->move_from_y = event->y;
+          priv->last_x = event->x;
+          priv->last_y = event->y;
+          priv->last_time = event->time;
+          priv->velocity_x = 0.0;
+          priv->velocity_y = 0.0;
           gtk_cifro_area_get_view (carea, &priv->start_from_x, &priv->start_to_x,
                                           &priv->start_from_y, &priv->start_to_y);
+          gtk_cifro_area_set_interacting (carea, TRUE);
         }
     }
 
   /* Выключаем режим перемещения. */
   if ((event->type == GDK_BUTTON_RELEASE) && (event->button == 1))
     {
+      if (priv->move_area)
+        {
+          gtk_cifro_area_set_interacting (carea, FALSE);
+
+          /* Продолжаем перемещение по инерции, если курсор двигался до отпускания. */
+          if (priv->animation && ((event->time - priv->last_time) < FLING_MAX_DELAY))
+            {
+              priv->view_animation = FALSE;
+              gtk_cifro_area_fling (carea, priv->velocity_x, priv->velocity_y);
+            }
+        }
       priv->move_area = FALSE;
     }
 
@@ -313,6 +515,23 @@ gtk_cifro_area_control_motion (GtkWidget      *widget,
       dx = x0 - xd;
       dy = y0 - yd;
 
+      /* Скорость перемещения области для продолжения по инерции. */
+      if (event->time > priv->last_time)
+        {
+          gdouble dt = (event->time - priv->last_time) / 1000.0;
+          gdouble xl, yl;
+
+          gtk_cifro_area_point_to_value (carea, priv->last_x, priv->last_y, &xl, &yl);
+          priv->velocity_x = VELOCITY_SMOOTHING * (xl - xd) / dt +
+                             (1.0 - VELOCITY_SMOOTHING) * priv->velocity_x;
+          priv->velocity_y = VELOCITY_SMOOTHING * (yl - yd) / dt +
+                             (1.0 - VELOCITY_SMOOTHING) * priv->velocity_y;
+
+          priv->last_x = event->x;
+          priv->last_y = event->y;
+          priv->last_time = event->time;
+        }
+
       gtk_cifro_area_set_view (carea, priv->start_from_x + dx, priv->start_to_x + dx,
                                       priv->start_from_y + dy, priv->start_to_y + dy);
 
@@ -332,10 +551,8 @@ gtk_cifro_area_control_scroll (GtkWidget      *widget,
   GtkCifroAreaControlPrivate *priv = control->priv;
 
   gint action = SCROLL_ACTION_NONE;
-  GtkCifroAreaZoomType zoom_x = GTK_CIFRO_AREA_ZOOM_NONE;
-  GtkCifroAreaZoomType zoom_y = GTK_CIFRO_AREA_ZOOM_NONE;
-  gint step_x = 0;
-  gint step_y = 0;
+  gdouble delta_x = 0.0;
+  gdouble delta_y = 0.0;
 
   /* Режимы обработки. */
   switch (priv->scroll_mode)
@@ -364,39 +581,85 @@ gtk_cifro_area_control_scroll (GtkWidget      *widget,
       break;
     }
 
-  /* Масштабирование. */
-  if ((action == SCROLL_ACTION_ZOOM_X) || (action == SCROLL_ACTION_ZOOM_BOTH))
-    zoom_x = (event->direction == GDK_SCROLL_UP) ? GTK_CIFRO_AREA_ZOOM_IN : GTK_CIFRO_AREA_ZOOM_OUT;
-  if ((action == SCROLL_ACTION_ZOOM_Y) || (action == SCROLL_ACTION_ZOOM_BOTH))
-    zoom_y = (event->direction == GDK_SCROLL_UP) ? GTK_CIFRO_AREA_ZOOM_IN : GTK_CIFRO_AREA_ZOOM_OUT;
+  if (action == SCROLL_ACTION_NONE)
+    return FALSE;
 
-  if ((zoom_x != GTK_CIFRO_AREA_ZOOM_NONE) || (zoom_y != GTK_CIFRO_AREA_ZOOM_NONE))
+  /* Величина прокрутки в шагах, положительная - вниз и вправо. */
+  switch (event->direction)
     {
-      gdouble val_x, val_y;
+    case GDK_SCROLL_UP:
+      delta_y = -1.0;
+      break;
+
+    case GDK_SCROLL_DOWN:
+      delta_y = 1.0;
+      break;
+
+    case GDK_SCROLL_LEFT:
+      delta_x = -1.0;
+      break;
+
+    case GDK_SCROLL_RIGHT:
+      delta_x = 1.0;
+      break;
 
-      gtk_cifro_area_point_to_value (carea, event->x, event->y, &val_x, &val_y);
-      gtk_cifro_area_zoom (carea, zoom_x, zoom_y, val_x, val_y);
+    default:
+#ifndef CIFRO_AREA_WITH_GTK2
+      if (!gdk_event_get_scroll_deltas ((GdkEvent*)event, &delta_x, &delta_y))
+        return FALSE;
+#endif
+      break;
     }
 
-  /* Перемещение. */
+  /* Перемещение по оси X выполняется горизонтальной прокруткой, а при её
+     отсутствии - вертикальной. Без модификаторов горизонтальная прокрутка
+     перемещает изображение по оси X, а вертикальная - по оси Y. */
   if (action == SCROLL_ACTION_MOVE_X)
-    step_x = (event->direction == GDK_SCROLL_UP) ? -priv->move_step : priv->move_step;
-  if (action == SCROLL_ACTION_MOVE_Y)
-    step_y = (event->direction == GDK_SCROLL_UP) ? priv->move_step : -priv->move_step;
+    {
+      if (delta_x == 0.0)
+        delta_x = delta_y;
+      delta_y = 0.0;
+    }
+  else if (action != SCROLL_ACTION_MOVE_Y)
+    {
+      delta_x = 0.0;
+    }
 
-  if ((step_x != 0) || (step_y != 0))
+  if ((delta_x == 0.0) && (delta_y == 0.0))
+    return FALSE;
+
+  gtk_cifro_area_stop_animation (carea);
+  gtk_cifro_area_set_interacting (carea, TRUE);
+
+  /* Накапливаем прокрутку до следующего кадра. */
+  priv->scroll_x = event->x;
+  priv->scroll_y = event->y;
+
+  if ((action == SCROLL_ACTION_ZOOM_X) || (action == SCROLL_ACTION_ZOOM_BOTH))
+    priv->scroll_zoom_x += delta_y;
+  if ((action == SCROLL_ACTION_ZOOM_Y) || (action == SCROLL_ACTION_ZOOM_BOTH))
+    priv->scroll_zoom_y += delta_y;
+
+  if ((action == SCROLL_ACTION_MOVE_X) || (action == SCROLL_ACTION_MOVE_Y))
     {
-      gtk_cifro_area_move (carea, step_x, step_y);
+      priv->scroll_move_x += delta_x * priv->move_step;
+      priv->scroll_move_y -= delta_y * priv->move_step;
     }
 
-  /* Поворот. */
   if (action == SCROLL_ACTION_ROTATE)
+    priv->scroll_angle -= delta_y * priv->rotate_step;
+
+#ifndef CIFRO_AREA_WITH_GTK2
+  if (gtk_widget_get_mapped (widget))
     {
-      gdouble angle;
+      if (priv->scroll_id == 0)
+        priv->scroll_id = gtk_widget_add_tick_callback (widget, gtk_cifro_area_control_scroll_tick, NULL, NULL);
 
-      angle = (event->direction == GDK_SCROLL_UP) ? priv->rotate_step : -priv->rotate_step;
-      gtk_cifro_area_rotate (carea, angle);
+      return FALSE;
     }
+#endif
+
+  gtk_cifro_area_control_apply_scroll (control);
 
   return FALSE;
 }
@@ -526,3 +789,42 @@ gtk_cifro_area_control_get_rotate_step (GtkCifroAreaControl *control)
 
   return control->priv->rotate_step;
 }
+
+/**
+ * gtk_cifro_area_control_set_animation:
+ * @control: указатель на #GtkCifroAreaControl
+ * @animation: включить или выключить анимацию
+ *
+ * Функция включает или выключает анимацию изменения вида. При включённой анимации
+ * перемещение и масштабирование с клавиатуры выполняются плавно, а перемещение
+ * мышкой продолжается по инерции после отпускания клавиши. По умолчанию анимация
+ * выключена.
+ *
+ */
+void
+gtk_cifro_area_control_set_animation (GtkCifroAreaControl *control,
+                                      gboolean             animation)
+{
+  g_return_if_fail (GTK_IS_CIFRO_AREA_CONTROL (control));
+
+  control->priv->animation = animation;
+  if (!animation)
+    gtk_cifro_area_stop_animation (GTK_CIFRO_AREA (control));
+}
+
+/**
+ * gtk_cifro_area_control_get_animation:
+ * @control: указатель на #GtkCifroAreaControl
+ *
+ * Функция возвращает признак анимации изменения вида.
+ *
+ * Returns: %TRUE если анимация включена, иначе %FALSE.
+ *
+ */
+gboolean
+gtk_cifro_area_control_get_animation (GtkCifroAreaControl *control)
+{
+  g_return_val_if_fail (GTK_IS_CIFRO_AREA_CONTROL (control), FALSE);
+
+  return control->priv->animation;
+}
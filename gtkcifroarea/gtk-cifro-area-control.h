@@ -44,7 +44,8 @@ G_BEGIN_DECLS
  *
  * В комбинированном режиме (@GTK_CIFRO_AREA_SCROLL_MODE_COMBINED) прокрутка колёсика
  * без нажатия клавиш приводит к перемещению изображения по оси Y, с нажатой клавишей
- * Ctrl к прокрутке по оси Y, Shift к масштабированию по обеим осям, Alt к повороту.
+ * Ctrl к прокрутке по оси X, Shift к масштабированию по обеим осям, Alt к повороту.
+ * Горизонтальная прокрутка без нажатия клавиш перемещает изображение по оси X.
  *
  */
 typedef enum
@@ -104,6 +105,13 @@ void                   gtk_cifro_area_control_set_rotate_step  (GtkCifroAreaCont
 GTK_CIFROAREA_EXPORT
 gdouble                gtk_cifro_area_control_get_rotate_step  (GtkCifroAreaControl    *control);
 
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_control_set_animation    (GtkCifroAreaControl    *control,
+                                                                gboolean                animation);
+
+GTK_CIFROAREA_EXPORT
+gboolean               gtk_cifro_area_control_get_animation    (GtkCifroAreaControl    *control);
+
 G_END_DECLS
 
 #endif /* __GTK_CIFRO_AREA_CONTROL_H__ */
@@ -67,15 +67,33 @@
  */
 
 #include "gtk-cifro-area.h"
+#include "cifro-area-trace.h"
 
 #include <gdk/gdkkeysyms.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
+/* Число кадров для расчёта частоты кадров и процентилей времени формирования кадра. */
+#define STATS_HISTORY          128
+
+/* Время без действий пользователя, после которого взаимодействие считается законченным, мс. */
+#define INTERACTION_IDLE_TIME  150
+
+/* Время формирования кадра по умолчанию, мкс. */
+#define DEFAULT_FRAME_BUDGET   16000
+
+/* Постоянная времени затухания скорости инерционного перемещения, мкс. */
+#define FLING_TIME_CONSTANT    325000
+
+/* Скорость, при которой инерционное перемещение прекращается, точек в секунду. */
+#define FLING_MIN_VELOCITY     20.0
+
 enum
 {
   SIGNAL_VISIBLE_DRAW,
   SIGNAL_AREA_DRAW,
+  SIGNAL_VIEW_CHANGED,
   SIGNAL_LAST
 };
 
@@ -90,9 +108,48 @@ enum
   SCROLL_ACTION_ROTATE
 };
 
+enum
+{
+  ANIMATION_NONE,
+  ANIMATION_VIEW,
+  ANIMATION_FLING
+};
+
 struct _GtkCifroAreaPrivate
 {
   cairo_t               *visible_cairo;        /* Объект для рисования в видимой области. */
+  gdouble                visible_scale;        /* Число точек поверхности видимой области в точке виджета. */
+  gboolean               offscreen;            /* Признак формирования изображения вне окна. */
+
+  gboolean               interacting;          /* Признак взаимодействия пользователя с виджетом. */
+  gboolean               interaction_downscale; /* Уменьшать (TRUE) или нет (FALSE) разрешение при взаимодействии. */
+  guint                  interaction_id;       /* Идентификатор таймера окончания взаимодействия. */
+
+  gint64                 frame_budget;         /* Допустимое время формирования кадра при взаимодействии, мкс. */
+  GtkCifroAreaQuality    quality;              /* Текущее качество формирования изображения. */
+  GtkCifroAreaQuality    interaction_quality;  /* Качество, достигнутое при последнем взаимодействии. */
+
+  gboolean               zoom_preview;         /* Показывать (TRUE) или нет (FALSE) предварительное изображение при масштабировании. */
+  gboolean               preview_pending;      /* Признак необходимости показать предварительное изображение. */
+  guint                  preview_id;           /* Идентификатор обработчика формирования изображения после предварительного. */
+  gboolean               rendered;             /* Признак наличия сформированного изображения в видимой области. */
+  gdouble                rendered_from_x;      /* Граница отображения по оси x сформированного изображения. */
+  gdouble                rendered_to_x;        /* Граница отображения по оси x сформированного изображения. */
+  gdouble                rendered_from_y;      /* Граница отображения по оси y сформированного изображения. */
+  gdouble                rendered_to_y;        /* Граница отображения по оси y сформированного изображения. */
+  gdouble                rendered_scale_x;     /* Масштаб по оси x сформированного изображения. */
+  gdouble                rendered_scale_y;     /* Масштаб по оси y сформированного изображения. */
+  gboolean               frame_reusable;       /* Признак возможности показа сформированного изображения при анимации. */
+
+  guint                  animation_id;         /* Идентификатор обработчика анимации. */
+  gint                   animation_type;       /* Тип анимации. */
+  gint64                 animation_start;      /* Время начала анимации, мкс. */
+  gint64                 animation_time;       /* Время предыдущего кадра анимации, мкс. */
+  gint64                 animation_duration;   /* Длительность анимации, мкс. */
+  gdouble                animation_from[4];    /* Начальные границы отображения. */
+  gdouble                animation_to[4];      /* Конечные границы отображения. */
+  gdouble                fling_velocity_x;     /* Скорость инерционного перемещения по оси x, единиц в секунду. */
+  gdouble                fling_velocity_y;     /* Скорость инерционного перемещения по оси y, единиц в секунду. */
 
   gboolean               swap_x;               /* TRUE - ось x направлена влево, FALSE - вправо. */
   gboolean               swap_y;               /* TRUE - ось y направлена вниз, FALSE - вверх. */
@@ -129,6 +186,11 @@ struct _GtkCifroAreaPrivate
   gboolean               scale_on_resize;      /* Изменять (TRUE) или нет (FALSE) масштаб при изменении размера окна. */
   gdouble                scale_x;              /* Текущий коэффициент масштаба по оси x. */
   gdouble                scale_y;              /* Текущий коэффициент масштаба по оси y. */
+
+  GtkCifroAreaRenderStats stats;               /* Статистика формирования изображения. */
+  gint64                 frame_starts[STATS_HISTORY]; /* Моменты начала формирования последних кадров, мкс. */
+  gint64                 frame_times[STATS_HISTORY];  /* Время формирования последних кадров, мкс. */
+  gboolean               stats_overlay;        /* Показывать (TRUE) или нет (FALSE) статистику поверх изображения. */
 };
 
 static void            gtk_cifro_area_object_finalize          (GObject                       *carea);
@@ -144,12 +206,47 @@ static guint           gtk_cifro_area_get_visible_height       (gdouble
 static void            gtk_cifro_area_update_visible           (GtkCifroArea                  *carea,
                                                                 gboolean                       update_scale);
 
+static cairo_surface_t *gtk_cifro_area_create_visible_surface  (GtkWidget                     *widget,
+                                                                guint                          width,
+                                                                guint                          height);
+
+static gdouble         gtk_cifro_area_get_render_scale         (GtkCifroArea                  *carea);
+
+static void            gtk_cifro_area_scale_factor_changed     (GObject                       *object,
+                                                                GParamSpec                    *pspec,
+                                                                gpointer                       data);
+
+static gboolean        gtk_cifro_area_interaction_idle         (gpointer                       data);
+
+static void            gtk_cifro_area_update_quality           (GtkCifroAreaPrivate           *priv);
+
+static gboolean        gtk_cifro_area_preview_idle             (gpointer                       data);
+
+static gboolean        gtk_cifro_area_can_reuse_frame          (GtkCifroArea                  *carea);
+
+static void            gtk_cifro_area_start_animation          (GtkCifroArea                  *carea,
+                                                                gint                           type);
+
+#ifndef CIFRO_AREA_WITH_GTK2
+static gboolean        gtk_cifro_area_animation_tick           (GtkWidget                     *widget,
+                                                                GdkFrameClock                 *clock,
+                                                                gpointer                       data);
+#endif
+
 static gboolean        gtk_cifro_area_configure                (GtkWidget                     *widget,
                                                                 GdkEventConfigure             *event);
 
+static void            gtk_cifro_area_unrealize                (GtkWidget                     *widget);
+
 static gboolean        gtk_cifro_area_draw                     (GtkWidget                     *widget,
                                                                 cairo_t                       *cairo);
 
+static void            gtk_cifro_area_update_stats             (GtkCifroAreaPrivate           *priv,
+                                                                gint64                         frame_start);
+
+static void            gtk_cifro_area_draw_stats               (GtkWidget                     *widget,
+                                                                cairo_t                       *cairo);
+
 #ifdef CIFRO_AREA_WITH_GTK2
 static gboolean        gtk_cifro_area_expose                   (GtkWidget                     *widget,
                                                                 GdkEventExpose                *event);
@@ -176,6 +273,9 @@ gtk_cifro_area_init (GtkCifroArea *carea)
   priv->from_y = -1.0;
   priv->to_y = 1.0;
 
+  priv->visible_scale = 1.0;
+  priv->frame_budget = DEFAULT_FRAME_BUDGET;
+
   event_mask |= GDK_ENTER_NOTIFY_MASK;
   event_mask |= GDK_LEAVE_NOTIFY_MASK;
   event_mask |= GDK_KEY_PRESS_MASK;
@@ -187,6 +287,10 @@ gtk_cifro_area_init (GtkCifroArea *carea)
   event_mask |= GDK_SCROLL_MASK;
   gtk_widget_add_events (GTK_WIDGET (carea), event_mask);
   gtk_widget_set_can_focus (GTK_WIDGET (carea), TRUE);
+
+#ifndef CIFRO_AREA_WITH_GTK2
+  g_signal_connect (carea, "notify::scale-factor", G_CALLBACK (gtk_cifro_area_scale_factor_changed), NULL);
+#endif
 }
 
 static void
@@ -197,6 +301,7 @@ gtk_cifro_area_class_init (GtkCifroAreaClass *klass)
 
   object_class->finalize = gtk_cifro_area_object_finalize;
   widget_class->configure_event = gtk_cifro_area_configure;
+  widget_class->unrealize = gtk_cifro_area_unrealize;
 #ifdef CIFRO_AREA_WITH_GTK2
   widget_class->expose_event = gtk_cifro_area_expose;
 #else
@@ -211,7 +316,8 @@ gtk_cifro_area_class_init (GtkCifroAreaClass *klass)
    * Сигнал отправляется при необходимости перерисовки изображения. Этот сигнал используется
    * для формирования изображения в видимой области. Конетекст cairo всегда имеет тип
    * [Cairo Image Surface] и допускает прямой доступ к памяти для ускорения формирования
-   * изображения.
+   * изображения. Рисование выполняется в точках поверхности, их число может отличаться
+   * от числа точек виджета, см. gtk_cifro_area_get_visible_size().
    *
    */
   gtk_cifro_area_signals[SIGNAL_VISIBLE_DRAW] =
@@ -241,6 +347,25 @@ gtk_cifro_area_class_init (GtkCifroAreaClass *klass)
                   NULL, NULL,
                   g_cclosure_marshal_VOID__POINTER,
                   G_TYPE_NONE, 1, G_TYPE_POINTER);
+
+  /**
+   * GtkCifroArea::view-changed:
+   * @carea: объект получивший сигнал
+   *
+   * Сигнал отправляется после пересчёта параметров отображения: изменения границ
+   * отображения, масштаба или размеров виджета. Сигнал отправляется вне цикла
+   * перерисовки, поэтому обработчик может изменить границы отображения, и изображение
+   * будет сформировано один раз уже с новыми границами.
+   *
+   */
+  gtk_cifro_area_signals[SIGNAL_VIEW_CHANGED] =
+    g_signal_new ("view-changed",
+                  GTK_TYPE_CIFRO_AREA,
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
 }
 
 static void
@@ -249,6 +374,11 @@ gtk_cifro_area_object_finalize (GObject *object)
   GtkCifroArea *carea = GTK_CIFRO_AREA (object);
   GtkCifroAreaPrivate *priv = carea->priv;
 
+  if (priv->interaction_id != 0)
+    g_source_remove (priv->interaction_id);
+  if (priv->preview_id != 0)
+    g_source_remove (priv->preview_id);
+
   g_clear_pointer (&priv->visible_cairo, cairo_destroy);
 
   G_OBJECT_CLASS (gtk_cifro_area_parent_class)->finalize (object);
@@ -298,8 +428,12 @@ gtk_cifro_area_update_visible (GtkCifroArea *carea,
   GtkCifroAreaPrivate *priv = carea->priv;
 
   guint visible_width, visible_height;
+  guint surface_width, surface_height;
+  gdouble visible_scale;
   gdouble x_width, y_height;
 
+  CIFRO_AREA_TRACE_BEGIN (update_visible);
+
   /* Параметры отображения. */
   gtk_cifro_area_get_swap (carea, &priv->swap_x, &priv->swap_y);
   gtk_cifro_area_get_stick (carea, &priv->stick_x, &priv->stick_y);
@@ -310,6 +444,7 @@ gtk_cifro_area_update_visible (GtkCifroArea *carea,
   if ((priv->widget_width <= (priv->border_left + priv->border_right)) ||
       (priv->widget_height <= (priv->border_top + priv->border_bottom)))
     {
+      CIFRO_AREA_TRACE_END (update_visible, update_scale);
       return;
     }
 
@@ -321,6 +456,11 @@ gtk_cifro_area_update_visible (GtkCifroArea *carea,
   visible_width = gtk_cifro_area_get_visible_width (priv->clip_width, priv->clip_height, priv->angle);
   visible_height = gtk_cifro_area_get_visible_height (priv->clip_width, priv->clip_height, priv->angle);
 
+  /* Чётность размеров видимой области совпадает с чётностью размеров виджета,
+     чтобы она размещалась по центру виджета без смещения на половину точки. */
+  visible_width += (priv->widget_width - visible_width) & 1;
+  visible_height += (priv->widget_height - visible_height) & 1;
+
   /* Обновляем коэффициенты масштабирования. */
   if (update_scale)
     {
@@ -410,28 +550,303 @@ gtk_cifro_area_update_visible (GtkCifroArea *carea,
         }
     }
 
-  /* Размеры видимой области изменились. */
-  if ((priv->visible_width != visible_width) || (priv->visible_height != visible_height))
+  /* Размеры поверхности видимой области в её точках. */
+  visible_scale = gtk_cifro_area_get_render_scale (carea);
+  surface_width = ceil (visible_width * visible_scale);
+  surface_height = ceil (visible_height * visible_scale);
+
+  /* Если поверхность меньше необходимого или изменился её масштаб,
+     пересоздаём объекты рисования в видимой области. */
+  if ((priv->visible_cairo == NULL) || (priv->visible_scale != visible_scale) ||
+      (surface_width > (guint) cairo_image_surface_get_width (cairo_get_target (priv->visible_cairo))) ||
+      (surface_height > (guint) cairo_image_surface_get_height (cairo_get_target (priv->visible_cairo))))
+    {
+      cairo_surface_t *surface;
+
+      if (priv->visible_cairo != NULL)
+        cairo_destroy (priv->visible_cairo);
+
+      surface = gtk_cifro_area_create_visible_surface (GTK_WIDGET (carea), surface_width, surface_height);
+      priv->visible_cairo = cairo_create (surface);
+      cairo_surface_destroy (surface);
+
+      priv->rendered = FALSE;
+    }
+
+  /* Запоминаем новые размеры видимой области. */
+  priv->visible_scale = visible_scale;
+  priv->visible_width = visible_width;
+  priv->visible_height = visible_height;
+
+  g_signal_emit (carea, gtk_cifro_area_signals[SIGNAL_VIEW_CHANGED], 0);
+
+  CIFRO_AREA_TRACE_END (update_visible, update_scale);
+}
+
+/* Функция создаёт поверхность для рисования в видимой области. Поверхность всегда
+   имеет тип cairo image surface с форматом ARGB32. Если окно виджета создано,
+   поверхность создаётся совместимой с ним, чтобы при выводе изображения в окно
+   не требовалось преобразование формата. Размеры поверхности задаются в её точках,
+   масштаб поверхности учитывается при выводе изображения в окно. */
+static cairo_surface_t *
+gtk_cifro_area_create_visible_surface (GtkWidget *widget,
+                                       guint      width,
+                                       guint      height)
+{
+#ifndef CIFRO_AREA_WITH_GTK2
+  GdkWindow *window = gtk_widget_get_window (widget);
+
+  if (window != NULL)
+    return gdk_window_create_similar_image_surface (window, CAIRO_FORMAT_ARGB32, width, height, 1);
+#endif
+
+  return cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+}
+
+/* Функция возвращает число точек поверхности видимой области в одной точке виджета:
+   коэффициент масштабирования окна, уменьшенный вдвое во время взаимодействия
+   пользователя с виджетом, если это разрешено. */
+static gdouble
+gtk_cifro_area_get_render_scale (GtkCifroArea *carea)
+{
+  GtkCifroAreaPrivate *priv = carea->priv;
+  gdouble scale = 1.0;
+
+  if (priv->offscreen)
+    return scale;
+
+#ifndef CIFRO_AREA_WITH_GTK2
+  scale = gtk_widget_get_scale_factor (GTK_WIDGET (carea));
+#endif
+
+  if (priv->interacting && priv->interaction_downscale)
+    scale /= 2.0;
+
+  return scale;
+}
+
+/* Обработчик изменения коэффициента масштабирования окна. */
+static void
+gtk_cifro_area_scale_factor_changed (GObject    *object,
+                                     GParamSpec *pspec,
+                                     gpointer    data)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (object);
+
+  gtk_cifro_area_update_visible (carea, FALSE);
+
+  gtk_widget_queue_draw (GTK_WIDGET (carea));
+}
+
+/* Обработчик окончания взаимодействия пользователя с виджетом. */
+static gboolean
+gtk_cifro_area_interaction_idle (gpointer data)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (data);
+  GtkCifroAreaPrivate *priv = carea->priv;
+
+  priv->interaction_id = 0;
+  priv->interacting = FALSE;
+
+  /* Формируем изображение с полным разрешением и качеством. */
+  if (priv->interaction_downscale)
+    gtk_cifro_area_update_visible (carea, FALSE);
+
+  if (priv->interaction_downscale || (priv->quality != GTK_CIFRO_AREA_QUALITY_FULL))
+    gtk_widget_queue_draw (GTK_WIDGET (carea));
+
+  priv->interaction_quality = priv->quality;
+  priv->quality = GTK_CIFRO_AREA_QUALITY_FULL;
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Функция выбирает качество следующего кадра по времени формирования последнего.
+   Если кадр не уложился в отведённое время, качество снижается на одну ступень,
+   если кадр сформирован в четыре раза быстрее - повышается. */
+static void
+gtk_cifro_area_update_quality (GtkCifroAreaPrivate *priv)
+{
+  if (!priv->interacting || priv->offscreen || (priv->frame_budget <= 0))
+    return;
+
+  if ((priv->stats.frame_time > priv->frame_budget) &&
+      (priv->quality < GTK_CIFRO_AREA_QUALITY_DRAFT))
+    {
+      priv->quality += 1;
+    }
+  else if ((priv->stats.frame_time < (priv->frame_budget / 4)) &&
+           (priv->quality > GTK_CIFRO_AREA_QUALITY_FULL))
+    {
+      priv->quality -= 1;
+    }
+}
+
+/* Обработчик формирования изображения после показа предварительного. Выполняется
+   после обработки поступивших событий, поэтому при непрерывном масштабировании
+   продолжает показываться предварительное изображение. */
+static gboolean
+gtk_cifro_area_preview_idle (gpointer data)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (data);
+
+  carea->priv->preview_id = 0;
+  gtk_widget_queue_draw (GTK_WIDGET (carea));
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Функция проверяет, можно ли во время анимации показать ранее сформированное
+   изображение вместо формирования нового. Изображение используется, если это
+   разрешено функцией gtk_cifro_area_set_frame_reusable(), оно полностью покрывает
+   видимую область и увеличивается не более чем в два раза. */
+static gboolean
+gtk_cifro_area_can_reuse_frame (GtkCifroArea *carea)
+{
+  GtkCifroAreaPrivate *priv = carea->priv;
+
+  if ((priv->animation_id == 0) || !priv->rendered || priv->offscreen)
+    return FALSE;
+
+  if (!priv->frame_reusable)
+    return FALSE;
+
+  if ((priv->from_x < priv->rendered_from_x) || (priv->to_x > priv->rendered_to_x) ||
+      (priv->from_y < priv->rendered_from_y) || (priv->to_y > priv->rendered_to_y))
+    return FALSE;
+
+  if (((2.0 * priv->scale_x) < priv->rendered_scale_x) ||
+      ((2.0 * priv->scale_y) < priv->rendered_scale_y))
+    return FALSE;
+
+  return TRUE;
+}
+
+/* Функция запускает анимацию границ отображения. */
+static void
+gtk_cifro_area_start_animation (GtkCifroArea *carea,
+                                gint          type)
+{
+  GtkCifroAreaPrivate *priv = carea->priv;
+
+#ifndef CIFRO_AREA_WITH_GTK2
+  if (priv->animation_id != 0)
+    gtk_widget_remove_tick_callback (GTK_WIDGET (carea), priv->animation_id);
+  else
+    gtk_cifro_area_set_interacting (carea, TRUE);
+
+  priv->animation_type = type;
+  priv->animation_start = 0;
+  priv->animation_time = 0;
+  priv->animation_id = gtk_widget_add_tick_callback (GTK_WIDGET (carea), gtk_cifro_area_animation_tick,
+                                                     NULL, NULL);
+#else
+  /* Без часов кадров анимация не выполняется, сразу устанавливаются конечные границы. */
+  if (type == ANIMATION_VIEW)
+    {
+      gtk_cifro_area_set_view (carea, priv->animation_to[0], priv->animation_to[1],
+                                      priv->animation_to[2], priv->animation_to[3]);
+    }
+#endif
+}
+
+#ifndef CIFRO_AREA_WITH_GTK2
+
+/* Обработчик кадра анимации. Границы отображения изменяются один раз за кадр. */
+static gboolean
+gtk_cifro_area_animation_tick (GtkWidget     *widget,
+                               GdkFrameClock *clock,
+                               gpointer       data)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (widget);
+  GtkCifroAreaPrivate *priv = carea->priv;
+
+  gint64 frame_time = gdk_frame_clock_get_frame_time (clock);
+  gboolean finished = FALSE;
+
+  if (priv->animation_type == ANIMATION_VIEW)
     {
-      /* Если новые размеры стали больше, пересоздаём объекты рисования в видимой области. */
-      if ((visible_width > priv->visible_width) || (visible_height > priv->visible_height))
+      gdouble view[4];
+      gdouble t, k;
+      guint i;
+
+      if (priv->animation_start == 0)
+        priv->animation_start = frame_time;
+
+      t = (gdouble) (frame_time - priv->animation_start) / priv->animation_duration;
+      if (t >= 1.0)
         {
-          cairo_surface_t *surface;
+          t = 1.0;
+          finished = TRUE;
+        }
 
-          if (priv->visible_cairo != NULL)
-            cairo_destroy (priv->visible_cairo);
+      /* Перемещение замедляется к концу анимации. */
+      k = 1.0 - pow (1.0 - t, 3.0);
+      for (i = 0; i < 4; i++)
+        view[i] = priv->animation_from[i] + (priv->animation_to[i] - priv->animation_from[i]) * k;
+
+      gtk_cifro_area_set_view (carea, view[0], view[1], view[2], view[3]);
+    }
+  else if (priv->animation_type == ANIMATION_FLING)
+    {
+      gdouble tau = FLING_TIME_CONSTANT / 1000000.0;
+      gdouble from_x, to_x, from_y, to_y;
+      gdouble shift_x, shift_y;
+      gdouble decay;
 
-          surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, visible_width, visible_height);
-          priv->visible_cairo = cairo_create (surface);
-          cairo_surface_destroy (surface);
+      if (priv->animation_time == 0)
+        {
+          priv->animation_time = frame_time;
+          return G_SOURCE_CONTINUE;
         }
 
-      /* Запоминаем новые размеры видимой области и сообщаем их. */
-      priv->visible_width = visible_width;
-      priv->visible_height = visible_height;
+      /* Скорость затухает экспоненциально, смещение за кадр равно интегралу скорости. */
+      decay = exp (-(gdouble) (frame_time - priv->animation_time) / FLING_TIME_CONSTANT);
+      priv->animation_time = frame_time;
+
+      shift_x = priv->fling_velocity_x * tau * (1.0 - decay);
+      shift_y = priv->fling_velocity_y * tau * (1.0 - decay);
+
+      from_x = priv->from_x;
+      to_x = priv->to_x;
+      from_y = priv->from_y;
+      to_y = priv->to_y;
+      gtk_cifro_area_set_view (carea, from_x + shift_x, to_x + shift_x, from_y + shift_y, to_y + shift_y);
+
+      /* При достижении пределов перемещения движение по оси прекращается. */
+      if (fabs (priv->from_x - from_x - shift_x) > (0.5 * fabs (shift_x)))
+        priv->fling_velocity_x = 0.0;
+      if (fabs (priv->from_y - from_y - shift_y) > (0.5 * fabs (shift_y)))
+        priv->fling_velocity_y = 0.0;
+
+      priv->fling_velocity_x *= decay;
+      priv->fling_velocity_y *= decay;
+
+      if ((fabs (priv->fling_velocity_x / priv->scale_x) < FLING_MIN_VELOCITY) &&
+          (fabs (priv->fling_velocity_y / priv->scale_y) < FLING_MIN_VELOCITY))
+        {
+          finished = TRUE;
+        }
+    }
+  else
+    {
+      finished = TRUE;
     }
+
+  if (!finished)
+    return G_SOURCE_CONTINUE;
+
+  /* После анимации изображение формируется заново. */
+  priv->animation_id = 0;
+  priv->animation_type = ANIMATION_NONE;
+  gtk_cifro_area_set_interacting (carea, FALSE);
+  gtk_widget_queue_draw (widget);
+
+  return G_SOURCE_REMOVE;
 }
 
+#endif
+
 /* Обработчик изменения размеров виджета. */
 static gboolean
 gtk_cifro_area_configure (GtkWidget         *widget,
@@ -448,6 +863,22 @@ gtk_cifro_area_configure (GtkWidget         *widget,
   return FALSE;
 }
 
+/* Обработчик удаления окна виджета. Поверхность видимой области, созданная
+   для этого окна, удаляется и будет создана заново для нового окна. */
+static void
+gtk_cifro_area_unrealize (GtkWidget *widget)
+{
+  GtkCifroAreaPrivate *priv = GTK_CIFRO_AREA (widget)->priv;
+
+  gtk_cifro_area_stop_animation (GTK_CIFRO_AREA (widget));
+
+  g_clear_pointer (&priv->visible_cairo, cairo_destroy);
+  priv->visible_width = 0;
+  priv->visible_height = 0;
+
+  GTK_WIDGET_CLASS (gtk_cifro_area_parent_class)->unrealize (widget);
+}
+
 /* Обработчик рисования содержимого виджета GTK 3. */
 static gboolean
 gtk_cifro_area_draw (GtkWidget *widget,
@@ -461,10 +892,36 @@ gtk_cifro_area_draw (GtkWidget *widget,
   gdouble shift_width = (cairo_width - priv->visible_width) / 2.0;
   gdouble shift_height = (cairo_height - priv->visible_height) / 2.0;
   gdouble angle = priv->angle;
+  gboolean preview;
+  gint64 frame_start;
+  gint64 phase_start;
 
   if ((priv->clip_width == 0) || (priv->clip_height == 0))
     return FALSE;
 
+  /* После изменения масштаба показывается ранее сформированное изображение,
+     а новое формируется в следующем кадре. */
+  preview = FALSE;
+  if (!priv->offscreen)
+    {
+      preview = priv->preview_pending && priv->rendered;
+      priv->preview_pending = FALSE;
+      if (preview && (priv->preview_id == 0))
+        priv->preview_id = g_idle_add (gtk_cifro_area_preview_idle, carea);
+    }
+
+  /* Во время анимации по возможности используется ранее сформированное изображение. */
+  if (!preview)
+    preview = gtk_cifro_area_can_reuse_frame (carea);
+
+  frame_start = g_get_monotonic_time ();
+  priv->stats.clear_time = 0;
+  priv->stats.visible_time = 0;
+  priv->stats.composite_time = 0;
+  priv->stats.samples = 0;
+  priv->stats.segments = 0;
+  priv->stats.pixels = 0;
+
   if (priv->swap_x)
     angle = -angle;
   if (priv->swap_y)
@@ -480,13 +937,35 @@ gtk_cifro_area_draw (GtkWidget *widget,
 
       /* Перед перерисовкой очищаем поверхность до прозрачного состояния
        * и выполняем перерисовку видимой области. */
-      cairo_surface_flush (surface);
+      if (!preview)
+        {
+          cairo_surface_flush (surface);
+
+          memset (data, 0, dsize);
+
+          phase_start = g_get_monotonic_time ();
+          priv->stats.clear_time = phase_start - frame_start;
+
+          CIFRO_AREA_TRACE_BEGIN (visible_draw);
+          g_signal_emit (GTK_CIFRO_AREA (widget), gtk_cifro_area_signals[SIGNAL_VISIBLE_DRAW],
+                         0, priv->visible_cairo);
+          CIFRO_AREA_TRACE_END (visible_draw, priv->visible_width * priv->visible_height);
+
+          cairo_surface_mark_dirty (surface);
+
+          priv->stats.visible_time = g_get_monotonic_time () - phase_start;
 
-      memset (data, 0, dsize);
-      g_signal_emit (GTK_CIFRO_AREA (widget), gtk_cifro_area_signals[SIGNAL_VISIBLE_DRAW],
-                     0, priv->visible_cairo);
+          /* Запоминаем параметры сформированного изображения. */
+          priv->rendered = TRUE;
+          priv->rendered_from_x = priv->from_x;
+          priv->rendered_to_x = priv->to_x;
+          priv->rendered_from_y = priv->from_y;
+          priv->rendered_to_y = priv->to_y;
+          priv->rendered_scale_x = priv->scale_x;
+          priv->rendered_scale_y = priv->scale_y;
+        }
 
-      cairo_surface_mark_dirty (surface);
+      phase_start = g_get_monotonic_time ();
 
       cairo_save (cairo);
 
@@ -504,7 +983,7 @@ gtk_cifro_area_draw (GtkWidget *widget,
           cairo_translate (cairo, 0, -cairo_height);
         }
 
-      if (angle != 0.0)
+      if ((angle != 0.0) || preview)
         {
           cairo_rectangle (cairo, priv->border_left, priv->border_top, priv->clip_width, priv->clip_height);
           cairo_clip (cairo);
@@ -515,20 +994,146 @@ gtk_cifro_area_draw (GtkWidget *widget,
           cairo_translate (cairo, -cairo_width / 2.0, -cairo_height / 2.0);
         }
 
-      cairo_set_source_surface (cairo, surface, shift_width, shift_height);
+      /* Предварительное изображение масштабируется так, чтобы его логические
+         координаты совпали с текущими. */
+      if (preview)
+        {
+          cairo_translate (cairo, shift_width + (priv->rendered_from_x - priv->from_x) / priv->scale_x,
+                                  shift_height + (priv->to_y - priv->rendered_to_y) / priv->scale_y);
+          cairo_scale (cairo, priv->rendered_scale_x / priv->scale_x / priv->visible_scale,
+                              priv->rendered_scale_y / priv->scale_y / priv->visible_scale);
+          cairo_set_source_surface (cairo, surface, 0.0, 0.0);
+        }
+
+      /* Поверхность видимой области масштабируется, если её точки не совпадают
+         с точками виджета. */
+      else if (priv->visible_scale != 1.0)
+        {
+          cairo_translate (cairo, shift_width, shift_height);
+          cairo_scale (cairo, 1.0 / priv->visible_scale, 1.0 / priv->visible_scale);
+          cairo_set_source_surface (cairo, surface, 0.0, 0.0);
+        }
+      else
+        {
+          cairo_set_source_surface (cairo, surface, shift_width, shift_height);
+        }
       cairo_paint (cairo);
 
       cairo_restore (cairo);
+
+      priv->stats.composite_time = g_get_monotonic_time () - phase_start;
     }
 
   /* Отображаем область всего виджета. */
+  phase_start = g_get_monotonic_time ();
   cairo_save (cairo);
+  CIFRO_AREA_TRACE_BEGIN (area_draw);
   g_signal_emit (GTK_CIFRO_AREA (widget), gtk_cifro_area_signals[SIGNAL_AREA_DRAW], 0, cairo);
+  CIFRO_AREA_TRACE_END (area_draw, priv->widget_width * priv->widget_height);
   cairo_restore (cairo);
+  priv->stats.area_time = g_get_monotonic_time () - phase_start;
+
+  /* Изображения, сформированные вне окна, не учитываются в истории кадров
+     и не влияют на выбор качества изображения в окне. */
+  if (priv->offscreen)
+    priv->stats.frame_time = g_get_monotonic_time () - frame_start;
+  else
+    gtk_cifro_area_update_stats (priv, frame_start);
+
+  if (!preview && !priv->offscreen)
+    gtk_cifro_area_update_quality (priv);
+
+  if (priv->stats_overlay)
+    gtk_cifro_area_draw_stats (widget, cairo);
 
   return TRUE;
 }
 
+/* Функция сравнения времени формирования кадров. */
+static gint
+gtk_cifro_area_compare_time (gconstpointer a,
+                             gconstpointer b)
+{
+  gint64 time1 = *(const gint64*) a;
+  gint64 time2 = *(const gint64*) b;
+
+  return (time1 > time2) - (time1 < time2);
+}
+
+/* Функция обновляет статистику после формирования кадра. */
+static void
+gtk_cifro_area_update_stats (GtkCifroAreaPrivate *priv,
+                             gint64               frame_start)
+{
+  gint64 frame_times[STATS_HISTORY];
+  guint n_frames;
+  guint first;
+  guint last;
+
+  last = priv->stats.frames % STATS_HISTORY;
+  priv->stats.frame_time = g_get_monotonic_time () - frame_start;
+  priv->frame_starts[last] = frame_start;
+  priv->frame_times[last] = priv->stats.frame_time;
+  priv->stats.frames += 1;
+
+  n_frames = MIN (priv->stats.frames, STATS_HISTORY);
+  first = (priv->stats.frames - n_frames) % STATS_HISTORY;
+
+  /* Частота кадров по интервалу между первым и последним кадрами истории. */
+  if ((n_frames > 1) && (priv->frame_starts[last] > priv->frame_starts[first]))
+    priv->stats.fps = 1e6 * (n_frames - 1) / (priv->frame_starts[last] - priv->frame_starts[first]);
+  else
+    priv->stats.fps = 0.0;
+
+  memcpy (frame_times, priv->frame_times, n_frames * sizeof (gint64));
+  qsort (frame_times, n_frames, sizeof (gint64), gtk_cifro_area_compare_time);
+
+  priv->stats.frame_time_p50 = frame_times[(n_frames - 1) * 50 / 100];
+  priv->stats.frame_time_p95 = frame_times[(n_frames - 1) * 95 / 100];
+  priv->stats.frame_time_p99 = frame_times[(n_frames - 1) * 99 / 100];
+}
+
+/* Функция рисует статистику формирования изображения поверх виджета. */
+static void
+gtk_cifro_area_draw_stats (GtkWidget *widget,
+                           cairo_t   *cairo)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (widget);
+  GtkCifroAreaPrivate *priv = carea->priv;
+
+  PangoLayout *font;
+  gchar *text;
+  gint width, height;
+
+  text = g_strdup_printf ("FPS %.1f\n"
+                          "p50 %.1f ms, p95 %.1f ms, p99 %.1f ms\n"
+                          "visible %.1f ms, area %.1f ms",
+                          priv->stats.fps,
+                          priv->stats.frame_time_p50 / 1000.0,
+                          priv->stats.frame_time_p95 / 1000.0,
+                          priv->stats.frame_time_p99 / 1000.0,
+                          priv->stats.visible_time / 1000.0,
+                          priv->stats.area_time / 1000.0);
+
+  font = gtk_widget_create_pango_layout (widget, text);
+  pango_layout_get_pixel_size (font, &width, &height);
+
+  cairo_save (cairo);
+
+  cairo_rectangle (cairo, priv->border_left, priv->border_top, width + 8, height + 8);
+  cairo_set_source_rgba (cairo, 0.0, 0.0, 0.0, 0.6);
+  cairo_fill (cairo);
+
+  cairo_move_to (cairo, priv->border_left + 4, priv->border_top + 4);
+  cairo_set_source_rgb (cairo, 1.0, 1.0, 1.0);
+  pango_cairo_show_layout (cairo, font);
+
+  cairo_restore (cairo);
+
+  g_object_unref (font);
+  g_free (text);
+}
+
 #ifdef CIFRO_AREA_WITH_GTK2
 
 /* Обработчик рисования содержимого виджета GTK 2. */
@@ -1101,7 +1706,9 @@ gtk_cifro_area_rotate (GtkCifroArea *carea,
  * @center_x: центр масштабирования по оси X, логические единицы
  * @center_y: центр масштабирования по оси Y, логические единицы
  *
- * Функция изменяет текущий масштаб изображения.
+ * Функция изменяет текущий масштаб изображения. Если включён показ предварительного
+ * изображения, см. gtk_cifro_area_set_zoom_preview(), в ближайшем кадре будет показано
+ * масштабированное ранее сформированное изображение.
  *
  */
 void
@@ -1119,6 +1726,9 @@ gtk_cifro_area_zoom (GtkCifroArea         *carea,
   klass = GTK_CIFRO_AREA_GET_CLASS (carea);
   priv = carea->priv;
 
+  if (priv->zoom_preview)
+    priv->preview_pending = TRUE;
+
   if (klass->zoom != NULL)
     {
       klass->zoom (carea, direction_x, direction_y, center_x, center_y);
@@ -1142,6 +1752,42 @@ gtk_cifro_area_zoom (GtkCifroArea         *carea,
     }
 }
 
+/**
+ * gtk_cifro_area_zoom_factor:
+ * @carea: указатель на #GtkCifroArea
+ * @factor_x: множитель масштаба по оси X
+ * @factor_y: множитель масштаба по оси Y
+ * @center_x: центр масштабирования по оси X, логические единицы
+ * @center_y: центр масштабирования по оси Y, логические единицы
+ *
+ * Функция изменяет текущий масштаб изображения в заданное число раз. Множитель
+ * меньше единицы увеличивает изображение, больше единицы - уменьшает. В отличие
+ * от gtk_cifro_area_zoom() функция не использует обработчик масштабирования
+ * класса и позволяет плавно изменять масштаб.
+ *
+ */
+void
+gtk_cifro_area_zoom_factor (GtkCifroArea *carea,
+                            gdouble       factor_x,
+                            gdouble       factor_y,
+                            gdouble       center_x,
+                            gdouble       center_y)
+{
+  GtkCifroAreaPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  g_return_if_fail (factor_x > 0.0);
+  g_return_if_fail (factor_y > 0.0);
+
+  priv = carea->priv;
+
+  if (priv->zoom_preview)
+    priv->preview_pending = TRUE;
+
+  gtk_cifro_area_set_scale (carea, factor_x * priv->scale_x, factor_y * priv->scale_y, center_x, center_y);
+}
+
 /**
  * gtk_cifro_area_get_size:
  * @carea: указатель на #GtkCifroArea
@@ -1172,7 +1818,10 @@ gtk_cifro_area_get_size (GtkCifroArea *carea,
  * @width: (out) (nullable): ширина видимой области
  * @height: (out) (nullable): используемая высота виджета
  *
- * Функция возвращает текущие значения размеров видимой области.
+ * Функция возвращает текущие значения размеров видимой области в точках поверхности,
+ * передаваемой в обработчик сигнала #GtkCifroArea::visible-draw. Число точек
+ * поверхности в одной точке виджета возвращает функция
+ * gtk_cifro_area_get_visible_scale_factor().
  *
  */
 void
@@ -1186,8 +1835,659 @@ gtk_cifro_area_get_visible_size (GtkCifroArea *carea,
 
   priv = carea->priv;
 
-  (width != NULL) ? *width = priv->visible_width : 0;
-  (height != NULL) ? *height = priv->visible_height : 0;
+  (width != NULL) ? *width = ceil (priv->visible_width * priv->visible_scale) : 0;
+  (height != NULL) ? *height = ceil (priv->visible_height * priv->visible_scale) : 0;
+}
+
+/**
+ * gtk_cifro_area_get_visible_scale_factor:
+ * @carea: указатель на #GtkCifroArea
+ *
+ * Функция возвращает число точек поверхности видимой области в одной точке виджета.
+ * Видимая область формируется с разрешением окна, поэтому для окон с коэффициентом
+ * масштабирования больше 1 поверхность видимой области содержит больше точек,
+ * чем виджет. Во время взаимодействия пользователя с виджетом разрешение может
+ * быть уменьшено вдвое, см. gtk_cifro_area_set_interaction_downscale().
+ *
+ * Returns: Число точек поверхности видимой области в одной точке виджета.
+ *
+ */
+gdouble
+gtk_cifro_area_get_visible_scale_factor (GtkCifroArea *carea)
+{
+  g_return_val_if_fail (GTK_IS_CIFRO_AREA (carea), 1.0);
+
+  return carea->priv->visible_scale;
+}
+
+/* Функция сообщает об изменении размеров виджета так же, как при размещении
+   виджета в окне, чтобы наследуемые классы подготовили свои параметры отображения. */
+static void
+gtk_cifro_area_emit_configure (GtkCifroArea *carea,
+                               guint         width,
+                               guint         height)
+{
+  gboolean handled;
+  GdkEvent *event;
+
+  carea->priv->clip_width = 0;
+  carea->priv->clip_height = 0;
+  event = gdk_event_new (GDK_CONFIGURE);
+  event->configure.send_event = TRUE;
+  event->configure.width = width;
+  event->configure.height = height;
+  g_signal_emit_by_name (carea, "configure-event", event, &handled);
+  gdk_event_free (event);
+}
+
+/* Функция формирует изображение вне цикла перерисовки GTK. Если view не равен NULL,
+   изображение формируется для границ отображения view. После формирования
+   изображения границы отображения и размеры виджета восстанавливаются. */
+static gboolean
+gtk_cifro_area_render_internal (GtkCifroArea    *carea,
+                                cairo_surface_t *surface,
+                                guint            width,
+                                guint            height,
+                                const gdouble   *view)
+{
+  GtkCifroAreaPrivate *priv = carea->priv;
+
+  gdouble from_x = priv->from_x;
+  gdouble to_x = priv->to_x;
+  gdouble from_y = priv->from_y;
+  gdouble to_y = priv->to_y;
+  guint widget_width = priv->widget_width;
+  guint widget_height = priv->widget_height;
+  gboolean status;
+  cairo_t *cairo;
+
+  priv->offscreen = TRUE;
+
+  if (view != NULL)
+    {
+      priv->from_x = view[0];
+      priv->to_x = view[1];
+      priv->from_y = view[2];
+      priv->to_y = view[3];
+    }
+
+  gtk_cifro_area_emit_configure (carea, width, height);
+
+  /* Размеры виджета на экране округляются до чётных, изображение
+     формируется точно указанного размера. */
+  priv->widget_width = width;
+  priv->widget_height = height;
+  gtk_cifro_area_update_visible (carea, TRUE);
+
+  cairo = cairo_create (surface);
+  status = gtk_cifro_area_draw (GTK_WIDGET (carea), cairo);
+  cairo_destroy (cairo);
+
+  cairo_surface_flush (surface);
+
+  /* Поверхность видимой области больше не содержит изображения виджета. */
+  priv->offscreen = FALSE;
+  priv->rendered = FALSE;
+
+  /* Восстанавливаем размеры виджета и границы отображения: при формировании
+     изображения они могли быть ограничены пределами или масштабом. */
+  if ((widget_width > 0) && (widget_height > 0))
+    gtk_cifro_area_emit_configure (carea, widget_width, widget_height);
+
+  priv->from_x = from_x;
+  priv->to_x = to_x;
+  priv->from_y = from_y;
+  priv->to_y = to_y;
+  gtk_cifro_area_update_visible (carea, TRUE);
+
+  return status;
+}
+
+/**
+ * gtk_cifro_area_render:
+ * @carea: указатель на #GtkCifroArea
+ * @surface: поверхность cairo для рисования
+ * @width: ширина изображения
+ * @height: высота изображения
+ *
+ * Функция формирует изображение размером width x height в поверхности surface вне
+ * цикла перерисовки GTK. Для формирования изображения отправляются сигналы
+ * #GtkCifroArea::visible-draw и #GtkCifroArea::area-draw, так же как при отображении
+ * виджета на экране. Виджет не обязательно должен быть размещён в окне, поэтому функцию
+ * можно использовать для пакетного формирования изображений, например в файлы PNG
+ * или PDF. Поверхность может быть любого типа, поддерживаемого cairo.
+ *
+ * Перед формированием изображения отправляется сигнал #GtkWidget::configure-event с его
+ * размерами. Масштаб пересчитывается под размер изображения. После формирования
+ * изображения границы отображения восстанавливаются, даже если они были ограничены
+ * пределами перемещения или масштаба. Если виджет уже имеет размеры, они также
+ * восстанавливаются и сигнал #GtkWidget::configure-event отправляется повторно.
+ *
+ * Изображение, сформированное этой функцией, не учитывается в частоте кадров и
+ * процентилях времени формирования кадра (см. gtk_cifro_area_get_render_stats()) и не
+ * влияет на качество изображения в окне. Время этапов и объём выполненной работы
+ * в статистике относятся к этому изображению.
+ *
+ * Returns: %TRUE если изображение сформировано.
+ *
+ */
+gboolean
+gtk_cifro_area_render (GtkCifroArea    *carea,
+                       cairo_surface_t *surface,
+                       guint            width,
+                       guint            height)
+{
+  g_return_val_if_fail (GTK_IS_CIFRO_AREA (carea), FALSE);
+  g_return_val_if_fail (surface != NULL, FALSE);
+
+  return gtk_cifro_area_render_internal (carea, surface, width, height, NULL);
+}
+
+/**
+ * gtk_cifro_area_render_view:
+ * @carea: указатель на #GtkCifroArea
+ * @surface: поверхность cairo для рисования
+ * @width: ширина изображения
+ * @height: высота изображения
+ * @from_x: минимальная граница изображения по оси X
+ * @to_x: максимальная граница изображения по оси X
+ * @from_y: минимальная граница изображения по оси Y
+ * @to_y: максимальная граница изображения по оси Y
+ *
+ * Функция аналогична gtk_cifro_area_render(), но формирует изображение для
+ * указанных границ отображения. Текущие границы отображения виджета не изменяются.
+ *
+ * Returns: %TRUE если изображение сформировано.
+ *
+ */
+gboolean
+gtk_cifro_area_render_view (GtkCifroArea    *carea,
+                            cairo_surface_t *surface,
+                            guint            width,
+                            guint            height,
+                            gdouble          from_x,
+                            gdouble          to_x,
+                            gdouble          from_y,
+                            gdouble          to_y)
+{
+  gdouble view[4] = { from_x, to_x, from_y, to_y };
+
+  g_return_val_if_fail (GTK_IS_CIFRO_AREA (carea), FALSE);
+  g_return_val_if_fail (surface != NULL, FALSE);
+  g_return_val_if_fail (from_x < to_x, FALSE);
+  g_return_val_if_fail (from_y < to_y, FALSE);
+
+  return gtk_cifro_area_render_internal (carea, surface, width, height, view);
+}
+
+/**
+ * gtk_cifro_area_get_render_stats:
+ * @carea: указатель на #GtkCifroArea
+ * @stats: (out): статистика формирования изображения
+ *
+ * Функция возвращает статистику формирования изображения: время отдельных этапов
+ * последнего кадра, частоту кадров и процентили времени формирования кадра.
+ *
+ */
+void
+gtk_cifro_area_get_render_stats (GtkCifroArea            *carea,
+                                 GtkCifroAreaRenderStats *stats)
+{
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+  g_return_if_fail (stats != NULL);
+
+  *stats = carea->priv->stats;
+}
+
+/**
+ * gtk_cifro_area_add_render_stats:
+ * @carea: указатель на #GtkCifroArea
+ * @samples: число просмотренных значений данных
+ * @segments: число нарисованных примитивов
+ * @pixels: число изменённых пикселей
+ *
+ * Функция добавляет к статистике текущего кадра объём выполненной работы. Функцию
+ * следует вызывать из обработчика сигнала #GtkCifroArea::visible-draw.
+ *
+ */
+void
+gtk_cifro_area_add_render_stats (GtkCifroArea *carea,
+                                 guint64       samples,
+                                 guint64       segments,
+                                 guint64       pixels)
+{
+  GtkCifroAreaPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  priv = carea->priv;
+
+  priv->stats.samples += samples;
+  priv->stats.segments += segments;
+  priv->stats.pixels += pixels;
+}
+
+/**
+ * gtk_cifro_area_set_stats_overlay:
+ * @carea: указатель на #GtkCifroArea
+ * @show: показывать или нет статистику
+ *
+ * Функция включает или выключает отображение частоты кадров и времени формирования
+ * кадра поверх изображения.
+ *
+ */
+void
+gtk_cifro_area_set_stats_overlay (GtkCifroArea *carea,
+                                  gboolean      show)
+{
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  carea->priv->stats_overlay = show;
+
+  gtk_widget_queue_draw (GTK_WIDGET (carea));
+}
+
+/**
+ * gtk_cifro_area_set_interaction_downscale:
+ * @carea: указатель на #GtkCifroArea
+ * @downscale: уменьшать или нет разрешение при взаимодействии
+ *
+ * Функция включает (@downscale = %TRUE) или выключает (@downscale = %FALSE) формирование
+ * видимой области с вдвое меньшим разрешением во время взаимодействия пользователя
+ * с виджетом. После окончания взаимодействия изображение формируется с полным
+ * разрешением. По умолчанию разрешение не уменьшается.
+ *
+ */
+void
+gtk_cifro_area_set_interaction_downscale (GtkCifroArea *carea,
+                                          gboolean      downscale)
+{
+  GtkCifroAreaPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  priv = carea->priv;
+
+  priv->interaction_downscale = downscale;
+
+  if (priv->interacting)
+    {
+      gtk_cifro_area_update_visible (carea, FALSE);
+      gtk_widget_queue_draw (GTK_WIDGET (carea));
+    }
+}
+
+/**
+ * gtk_cifro_area_get_interaction_downscale:
+ * @carea: указатель на #GtkCifroArea
+ *
+ * Функция возвращает признак уменьшения разрешения видимой области во время
+ * взаимодействия пользователя с виджетом.
+ *
+ * Returns: %TRUE если разрешение уменьшается, иначе %FALSE.
+ *
+ */
+gboolean
+gtk_cifro_area_get_interaction_downscale (GtkCifroArea *carea)
+{
+  g_return_val_if_fail (GTK_IS_CIFRO_AREA (carea), FALSE);
+
+  return carea->priv->interaction_downscale;
+}
+
+/**
+ * gtk_cifro_area_set_interacting:
+ * @carea: указатель на #GtkCifroArea
+ * @interacting: признак взаимодействия пользователя с виджетом
+ *
+ * Функция сообщает о начале (@interacting = %TRUE) или окончании (@interacting = %FALSE)
+ * взаимодействия пользователя с виджетом: перемещения, масштабирования или поворота
+ * изображения. Окончание взаимодействия фиксируется с задержкой, если за это время
+ * взаимодействие возобновится, изображение продолжит формироваться как при взаимодействии.
+ * Для одиночных действий, например прокрутки колёсика мышки, функцию следует вызывать
+ * дважды: с @interacting = %TRUE до действия и с @interacting = %FALSE после него.
+ *
+ * Функция вызывается #GtkCifroAreaControl при управлении видом мышкой.
+ *
+ * Во время взаимодействия качество изображения выбирается так, чтобы кадр
+ * формировался не дольше заданного функцией gtk_cifro_area_set_frame_budget() времени.
+ * После окончания взаимодействия изображение формируется с полным качеством.
+ *
+ */
+void
+gtk_cifro_area_set_interacting (GtkCifroArea *carea,
+                                gboolean      interacting)
+{
+  GtkCifroAreaPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  priv = carea->priv;
+
+  if (priv->interaction_id != 0)
+    {
+      g_source_remove (priv->interaction_id);
+      priv->interaction_id = 0;
+    }
+
+  if (interacting)
+    {
+      if (priv->interacting)
+        return;
+
+      /* Взаимодействие начинается с качества, достигнутого в прошлый раз. */
+      priv->interacting = TRUE;
+      if (priv->frame_budget > 0)
+        priv->quality = priv->interaction_quality;
+
+      if (priv->interaction_downscale)
+        {
+          gtk_cifro_area_update_visible (carea, FALSE);
+          gtk_widget_queue_draw (GTK_WIDGET (carea));
+        }
+    }
+  else if (priv->interacting)
+    {
+      priv->interaction_id = g_timeout_add (INTERACTION_IDLE_TIME, gtk_cifro_area_interaction_idle, carea);
+    }
+}
+
+/**
+ * gtk_cifro_area_get_interacting:
+ * @carea: указатель на #GtkCifroArea
+ *
+ * Функция возвращает признак взаимодействия пользователя с виджетом.
+ *
+ * Returns: %TRUE если пользователь взаимодействует с виджетом, иначе %FALSE.
+ *
+ */
+gboolean
+gtk_cifro_area_get_interacting (GtkCifroArea *carea)
+{
+  g_return_val_if_fail (GTK_IS_CIFRO_AREA (carea), FALSE);
+
+  return carea->priv->interacting;
+}
+
+/**
+ * gtk_cifro_area_set_zoom_preview:
+ * @carea: указатель на #GtkCifroArea
+ * @preview: показывать или нет предварительное изображение
+ *
+ * Функция включает (@preview = %TRUE) или выключает (@preview = %FALSE) показ
+ * предварительного изображения при изменении масштаба функцией gtk_cifro_area_zoom().
+ * Предварительное изображение получается масштабированием ранее сформированного
+ * изображения видимой области относительно центра масштабирования и показывается
+ * без отправки сигнала #GtkCifroArea::visible-draw. Новое изображение формируется
+ * после обработки всех поступивших событий, поэтому при непрерывном масштабировании
+ * изображение видимой области формируется не чаще одного раза за кадр.
+ * По умолчанию предварительное изображение не показывается.
+ *
+ */
+void
+gtk_cifro_area_set_zoom_preview (GtkCifroArea *carea,
+                                 gboolean      preview)
+{
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  carea->priv->zoom_preview = preview;
+  carea->priv->preview_pending = FALSE;
+}
+
+/**
+ * gtk_cifro_area_get_zoom_preview:
+ * @carea: указатель на #GtkCifroArea
+ *
+ * Функция возвращает признак показа предварительного изображения при изменении масштаба.
+ *
+ * Returns: %TRUE если предварительное изображение показывается, иначе %FALSE.
+ *
+ */
+gboolean
+gtk_cifro_area_get_zoom_preview (GtkCifroArea *carea)
+{
+  g_return_val_if_fail (GTK_IS_CIFRO_AREA (carea), FALSE);
+
+  return carea->priv->zoom_preview;
+}
+
+/**
+ * gtk_cifro_area_set_frame_budget:
+ * @carea: указатель на #GtkCifroArea
+ * @budget: допустимое время формирования кадра, мкс
+ *
+ * Функция устанавливает допустимое время формирования кадра во время взаимодействия
+ * пользователя с виджетом. Если кадр формируется дольше, качество следующих кадров
+ * снижается, см. gtk_cifro_area_get_quality(). Значение 0 выключает снижение качества.
+ * По умолчанию допустимое время формирования кадра равно 16 мс.
+ *
+ */
+void
+gtk_cifro_area_set_frame_budget (GtkCifroArea *carea,
+                                 gint64        budget)
+{
+  GtkCifroAreaPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  priv = carea->priv;
+
+  priv->frame_budget = MAX (budget, 0);
+  priv->interaction_quality = GTK_CIFRO_AREA_QUALITY_FULL;
+  if (priv->frame_budget == 0)
+    priv->quality = GTK_CIFRO_AREA_QUALITY_FULL;
+
+  gtk_widget_queue_draw (GTK_WIDGET (carea));
+}
+
+/**
+ * gtk_cifro_area_get_frame_budget:
+ * @carea: указатель на #GtkCifroArea
+ *
+ * Функция возвращает допустимое время формирования кадра во время взаимодействия
+ * пользователя с виджетом.
+ *
+ * Returns: Допустимое время формирования кадра, мкс.
+ *
+ */
+gint64
+gtk_cifro_area_get_frame_budget (GtkCifroArea *carea)
+{
+  g_return_val_if_fail (GTK_IS_CIFRO_AREA (carea), 0);
+
+  return carea->priv->frame_budget;
+}
+
+/**
+ * gtk_cifro_area_get_quality:
+ * @carea: указатель на #GtkCifroArea
+ *
+ * Функция возвращает качество, с которым должно формироваться изображение в видимой
+ * области. Функцию следует вызывать из обработчика сигнала #GtkCifroArea::visible-draw
+ * и упрощать изображение, если качество ниже %GTK_CIFRO_AREA_QUALITY_FULL. При
+ * формировании изображения функцией gtk_cifro_area_render() качество всегда полное.
+ *
+ * Returns: Качество формирования изображения.
+ *
+ */
+GtkCifroAreaQuality
+gtk_cifro_area_get_quality (GtkCifroArea *carea)
+{
+  g_return_val_if_fail (GTK_IS_CIFRO_AREA (carea), GTK_CIFRO_AREA_QUALITY_FULL);
+
+  if (carea->priv->offscreen)
+    return GTK_CIFRO_AREA_QUALITY_FULL;
+
+  return carea->priv->quality;
+}
+
+/**
+ * gtk_cifro_area_animate_view:
+ * @carea: указатель на #GtkCifroArea
+ * @from_x: минимальная граница изображения по оси X
+ * @to_x: максимальная граница изображения по оси X
+ * @from_y: минимальная граница изображения по оси Y
+ * @to_y: максимальная граница изображения по оси Y
+ * @duration: длительность анимации, мс
+ *
+ * Функция плавно изменяет границы отображения от текущих до заданных за время
+ * @duration. Границы изменяются один раз за кадр, при этом, если это разрешено
+ * функцией gtk_cifro_area_set_frame_reusable(), вместо формирования нового изображения
+ * показывается масштабированное ранее сформированное. Во время анимации виджет
+ * считается находящимся во взаимодействии с пользователем, см.
+ * gtk_cifro_area_set_interacting(). Начатая ранее анимация прекращается.
+ *
+ * При сборке с GTK 2 границы отображения устанавливаются сразу.
+ *
+ */
+void
+gtk_cifro_area_animate_view (GtkCifroArea *carea,
+                             gdouble       from_x,
+                             gdouble       to_x,
+                             gdouble       from_y,
+                             gdouble       to_y,
+                             guint         duration)
+{
+  GtkCifroAreaPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  g_return_if_fail (from_x < to_x);
+  g_return_if_fail (from_y < to_y);
+
+  priv = carea->priv;
+
+  if ((duration == 0) || !gtk_widget_get_mapped (GTK_WIDGET (carea)))
+    {
+      gtk_cifro_area_stop_animation (carea);
+      gtk_cifro_area_set_view (carea, from_x, to_x, from_y, to_y);
+      return;
+    }
+
+  priv->animation_from[0] = priv->from_x;
+  priv->animation_from[1] = priv->to_x;
+  priv->animation_from[2] = priv->from_y;
+  priv->animation_from[3] = priv->to_y;
+  priv->animation_to[0] = from_x;
+  priv->animation_to[1] = to_x;
+  priv->animation_to[2] = from_y;
+  priv->animation_to[3] = to_y;
+  priv->animation_duration = 1000 * (gint64) duration;
+
+  gtk_cifro_area_start_animation (carea, ANIMATION_VIEW);
+}
+
+/**
+ * gtk_cifro_area_fling:
+ * @carea: указатель на #GtkCifroArea
+ * @velocity_x: начальная скорость перемещения по оси X, логических единиц в секунду
+ * @velocity_y: начальная скорость перемещения по оси Y, логических единиц в секунду
+ *
+ * Функция запускает инерционное перемещение изображения. Скорость перемещения
+ * экспоненциально затухает, перемещение прекращается при снижении скорости до
+ * нескольких точек в секунду. Перемещение по оси прекращается при достижении
+ * пределов перемещения. Начатая ранее анимация прекращается.
+ *
+ * При сборке с GTK 2 инерционное перемещение не выполняется.
+ *
+ */
+void
+gtk_cifro_area_fling (GtkCifroArea *carea,
+                      gdouble       velocity_x,
+                      gdouble       velocity_y)
+{
+  GtkCifroAreaPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  priv = carea->priv;
+
+  gtk_cifro_area_stop_animation (carea);
+
+  if (!gtk_widget_get_mapped (GTK_WIDGET (carea)))
+    return;
+
+  if ((fabs (velocity_x / priv->scale_x) < FLING_MIN_VELOCITY) &&
+      (fabs (velocity_y / priv->scale_y) < FLING_MIN_VELOCITY))
+    {
+      return;
+    }
+
+  priv->fling_velocity_x = velocity_x;
+  priv->fling_velocity_y = velocity_y;
+
+  gtk_cifro_area_start_animation (carea, ANIMATION_FLING);
+}
+
+/**
+ * gtk_cifro_area_stop_animation:
+ * @carea: указатель на #GtkCifroArea
+ *
+ * Функция прекращает анимацию границ отображения или инерционное перемещение.
+ * Границы отображения остаются такими, какими были в последнем кадре анимации.
+ *
+ */
+void
+gtk_cifro_area_stop_animation (GtkCifroArea *carea)
+{
+  GtkCifroAreaPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  priv = carea->priv;
+
+  if (priv->animation_id == 0)
+    return;
+
+#ifndef CIFRO_AREA_WITH_GTK2
+  gtk_widget_remove_tick_callback (GTK_WIDGET (carea), priv->animation_id);
+#endif
+  priv->animation_id = 0;
+  priv->animation_type = ANIMATION_NONE;
+
+  gtk_cifro_area_set_interacting (carea, FALSE);
+  gtk_widget_queue_draw (GTK_WIDGET (carea));
+}
+
+/**
+ * gtk_cifro_area_get_animating:
+ * @carea: указатель на #GtkCifroArea
+ *
+ * Функция возвращает признак выполнения анимации границ отображения.
+ *
+ * Returns: %TRUE если выполняется анимация, иначе %FALSE.
+ *
+ */
+gboolean
+gtk_cifro_area_get_animating (GtkCifroArea *carea)
+{
+  g_return_val_if_fail (GTK_IS_CIFRO_AREA (carea), FALSE);
+
+  return carea->priv->animation_id != 0;
+}
+
+/**
+ * gtk_cifro_area_set_frame_reusable:
+ * @carea: указатель на #GtkCifroArea
+ * @reusable: возможность показа ранее сформированного изображения
+ *
+ * Функция разрешает или запрещает показ ранее сформированного изображения видимой
+ * области во время анимации границ отображения. Изображение показывается с
+ * преобразованием вместо формирования нового, поэтому разрешение следует давать,
+ * только пока содержимое видимой области не изменилось. Функция предназначена
+ * для наследуемых классов: обычно разрешение даётся при рисовании в обработчике
+ * сигнала #GtkCifroArea::visible-draw и снимается при изменении данных.
+ *
+ * По умолчанию показ ранее сформированного изображения запрещён.
+ *
+ */
+void
+gtk_cifro_area_set_frame_reusable (GtkCifroArea *carea,
+                                   gboolean      reusable)
+{
+  g_return_if_fail (GTK_IS_CIFRO_AREA (carea));
+
+  carea->priv->frame_reusable = reusable;
 }
 
 /**
@@ -1295,8 +2595,8 @@ gtk_cifro_area_value_to_point (GtkCifroArea *carea,
 /**
  * gtk_cifro_area_visible_point_to_value:
  * @carea: указатель на #GtkCifroArea
- * @x: координата x в видимой области
- * @y: координата y в видимой области
+ * @x: координата x в точках поверхности видимой области
+ * @y: координата y в точках поверхности видимой области
  * @x_val: (out) (nullable): значение x в логической системе координат
  * @y_val: (out) (nullable): значение y в логической системе координат
  *
@@ -1317,15 +2617,15 @@ gtk_cifro_area_visible_point_to_value (GtkCifroArea *carea,
 
   priv = carea->priv;
 
-  (x_val != NULL) ? *x_val = (priv->from_x + x * priv->scale_x) : 0;
-  (y_val != NULL) ? *y_val = (priv->to_y - y * priv->scale_y) : 0;
+  (x_val != NULL) ? *x_val = (priv->from_x + x * priv->scale_x / priv->visible_scale) : 0;
+  (y_val != NULL) ? *y_val = (priv->to_y - y * priv->scale_y / priv->visible_scale) : 0;
 }
 
 /**
  * gtk_cifro_area_visible_value_to_point:
  * @carea: указатель на #GtkCifroArea
- * @x: (out) (nullable): координата x в видимой области
- * @y: (out) (nullable): координата y в видимой области
+ * @x: (out) (nullable): координата x в точках поверхности видимой области
+ * @y: (out) (nullable): координата y в точках поверхности видимой области
  * @x_val: значение x в логической системе координат
  * @y_val: значение y в логической системе координат
  *
@@ -1346,8 +2646,8 @@ gtk_cifro_area_visible_value_to_point (GtkCifroArea *carea,
 
   priv = carea->priv;
 
-  (x != NULL) ? *x = ((x_val - priv->from_x) / priv->scale_x) : 0;
-  (y != NULL) ? *y = ((priv->to_y - y_val) / priv->scale_y) : 0;
+  (x != NULL) ? *x = ((x_val - priv->from_x) / priv->scale_x * priv->visible_scale) : 0;
+  (y != NULL) ? *y = ((priv->to_y - y_val) / priv->scale_y * priv->visible_scale) : 0;
 }
 
 /**
@@ -68,6 +68,63 @@ typedef enum
   GTK_CIFRO_AREA_ZOOM_OUT
 } GtkCifroAreaZoomType;
 
+/**
+ * GtkCifroAreaQuality:
+ * @GTK_CIFRO_AREA_QUALITY_FULL: Полное качество изображения.
+ * @GTK_CIFRO_AREA_QUALITY_FAST: Упрощённое изображение, второстепенные элементы могут не рисоваться.
+ * @GTK_CIFRO_AREA_QUALITY_DRAFT: Черновое изображение с минимальными затратами на формирование.
+ *
+ * Определяет качество формирования изображения в видимой области. Качество снижается
+ * во время взаимодействия пользователя с виджетом, если кадр не успевает сформироваться
+ * за отведённое время.
+ *
+ */
+typedef enum
+{
+  GTK_CIFRO_AREA_QUALITY_FULL,
+  GTK_CIFRO_AREA_QUALITY_FAST,
+  GTK_CIFRO_AREA_QUALITY_DRAFT
+} GtkCifroAreaQuality;
+
+/**
+ * GtkCifroAreaRenderStats:
+ * @frames: Число сформированных кадров.
+ * @clear_time: Время очистки видимой области в последнем кадре, мкс.
+ * @visible_time: Время обработки сигнала #GtkCifroArea::visible-draw в последнем кадре, мкс.
+ * @composite_time: Время вывода видимой области в последнем кадре, мкс.
+ * @area_time: Время обработки сигнала #GtkCifroArea::area-draw в последнем кадре, мкс.
+ * @frame_time: Полное время формирования последнего кадра, мкс.
+ * @samples: Число просмотренных значений данных в последнем кадре.
+ * @segments: Число нарисованных примитивов в последнем кадре.
+ * @pixels: Число изменённых пикселей видимой области в последнем кадре.
+ * @fps: Частота формирования кадров.
+ * @frame_time_p50: Медиана времени формирования кадра, мкс.
+ * @frame_time_p95: 95-й процентиль времени формирования кадра, мкс.
+ * @frame_time_p99: 99-й процентиль времени формирования кадра, мкс.
+ *
+ * Статистика формирования изображения. Частота кадров и процентили времени формирования
+ * кадра рассчитываются по последним 128 кадрам. Значения @samples, @segments и @pixels
+ * сообщаются обработчиками сигнала #GtkCifroArea::visible-draw с помощью функции
+ * gtk_cifro_area_add_render_stats().
+ *
+ */
+typedef struct
+{
+  guint64              frames;
+  gint64               clear_time;
+  gint64               visible_time;
+  gint64               composite_time;
+  gint64               area_time;
+  gint64               frame_time;
+  guint64              samples;
+  guint64              segments;
+  guint64              pixels;
+  gdouble              fps;
+  gint64               frame_time_p50;
+  gint64               frame_time_p95;
+  gint64               frame_time_p99;
+} GtkCifroAreaRenderStats;
+
 #define GTK_TYPE_CIFRO_AREA             (gtk_cifro_area_get_type ())
 #define GTK_CIFRO_AREA(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), GTK_TYPE_CIFRO_AREA, GtkCifroArea))
 #define GTK_IS_CIFRO_AREA(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GTK_TYPE_CIFRO_AREA))
@@ -234,6 +291,13 @@ void                   gtk_cifro_area_zoom                     (GtkCifroArea
                                                                 gdouble                center_x,
                                                                 gdouble                center_y);
 
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_zoom_factor              (GtkCifroArea          *carea,
+                                                                gdouble                factor_x,
+                                                                gdouble                factor_y,
+                                                                gdouble                center_x,
+                                                                gdouble                center_y);
+
 GTK_CIFROAREA_EXPORT
 void                   gtk_cifro_area_get_size                 (GtkCifroArea          *carea,
                                                                 guint                 *width,
@@ -244,6 +308,93 @@ void                   gtk_cifro_area_get_visible_size         (GtkCifroArea
                                                                 guint                 *width,
                                                                 guint                 *height);
 
+GTK_CIFROAREA_EXPORT
+gdouble                gtk_cifro_area_get_visible_scale_factor (GtkCifroArea          *carea);
+
+GTK_CIFROAREA_EXPORT
+gboolean               gtk_cifro_area_render                   (GtkCifroArea          *carea,
+                                                                cairo_surface_t       *surface,
+                                                                guint                  width,
+                                                                guint                  height);
+
+GTK_CIFROAREA_EXPORT
+gboolean               gtk_cifro_area_render_view              (GtkCifroArea          *carea,
+                                                                cairo_surface_t       *surface,
+                                                                guint                  width,
+                                                                guint                  height,
+                                                                gdouble                from_x,
+                                                                gdouble                to_x,
+                                                                gdouble                from_y,
+                                                                gdouble                to_y);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_get_render_stats         (GtkCifroArea          *carea,
+                                                                GtkCifroAreaRenderStats *stats);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_add_render_stats         (GtkCifroArea          *carea,
+                                                                guint64                samples,
+                                                                guint64                segments,
+                                                                guint64                pixels);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_set_stats_overlay        (GtkCifroArea          *carea,
+                                                                gboolean               show);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_set_interaction_downscale (GtkCifroArea         *carea,
+                                                                gboolean               downscale);
+
+GTK_CIFROAREA_EXPORT
+gboolean               gtk_cifro_area_get_interaction_downscale (GtkCifroArea         *carea);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_set_interacting          (GtkCifroArea          *carea,
+                                                                gboolean               interacting);
+
+GTK_CIFROAREA_EXPORT
+gboolean               gtk_cifro_area_get_interacting          (GtkCifroArea          *carea);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_set_zoom_preview         (GtkCifroArea          *carea,
+                                                                gboolean               preview);
+
+GTK_CIFROAREA_EXPORT
+gboolean               gtk_cifro_area_get_zoom_preview         (GtkCifroArea          *carea);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_set_frame_budget         (GtkCifroArea          *carea,
+                                                                gint64                 budget);
+
+GTK_CIFROAREA_EXPORT
+gint64                 gtk_cifro_area_get_frame_budget         (GtkCifroArea          *carea);
+
+GTK_CIFROAREA_EXPORT
+GtkCifroAreaQuality    gtk_cifro_area_get_quality              (GtkCifroArea          *carea);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_animate_view             (GtkCifroArea          *carea,
+                                                                gdouble                from_x,
+                                                                gdouble                to_x,
+                                                                gdouble                from_y,
+                                                                gdouble                to_y,
+                                                                guint                  duration);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_fling                    (GtkCifroArea          *carea,
+                                                                gdouble                velocity_x,
+                                                                gdouble                velocity_y);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_stop_animation           (GtkCifroArea          *carea);
+
+GTK_CIFROAREA_EXPORT
+gboolean               gtk_cifro_area_get_animating            (GtkCifroArea          *carea);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_area_set_frame_reusable       (GtkCifroArea          *carea,
+                                                                gboolean               reusable);
+
 GTK_CIFROAREA_EXPORT
 void                   gtk_cifro_area_point_to_value           (GtkCifroArea          *carea,
                                                                 gdouble                x,
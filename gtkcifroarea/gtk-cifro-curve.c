@@ -51,6 +51,7 @@
 #include "gtk-cifro-curve.h"
 #include "cairo-sdline.h"
 
+#include <string.h>
 #include <math.h>
 
 enum
@@ -60,11 +61,28 @@ enum
   PROP_CURVE_DATA
 };
 
+/* Параметры, от которых зависит изображение кривой. */
+typedef struct
+{
+  gdouble                      from_x;                         /* Границы видимой области. */
+  gdouble                      to_x;
+  gdouble                      from_y;
+  gdouble                      to_y;
+  guint                        width;                          /* Размеры видимой области. */
+  guint                        height;
+  guint32                      color;                          /* Цвет кривой. */
+  guint                        generation;                     /* Номер версии точек кривой. */
+} GtkCifroCurveDrawKey;
+
 struct _GtkCifroCurvePrivate
 {
   GArray                      *curve_points;                   /* Точки кривой. */
   GtkCifroCurveFunc            curve_func;                     /* Функция расчёта значений кривой. */
   gpointer                     curve_data;                     /* Пользовательские данные для функции расчёта значений кривой. */
+  guint                        curve_generation;               /* Номер версии точек кривой, изменяется при их обновлении. */
+
+  cairo_sdline_commands       *curve_commands;                 /* Записанные команды рисования кривой. */
+  GtkCifroCurveDrawKey         curve_key;                      /* Параметры, для которых записаны команды. */
 
   guint32                      curve_color;                    /* Цвет кривой. */
   guint32                      point_color;                    /* Цвет точек. */
@@ -107,6 +125,7 @@ gtk_cifro_curve_init (GtkCifroCurve *ccurve)
 
   /* Контрольные точки кривой. */
   priv->curve_points = g_array_new (FALSE, FALSE, sizeof (GtkCifroCurvePoint));
+  priv->curve_commands = cairo_sdline_commands_new ();
 
   /* Цвета по умолчанию. */
   priv->curve_color = cairo_sdline_color (g_random_double_range (0.5, 1.0),
@@ -155,10 +174,12 @@ gtk_cifro_curve_set_property (GObject      *object,
     {
       case PROP_CURVE_FUNC:
         priv->curve_func = g_value_get_pointer (value);
+        priv->curve_generation += 1;
         break;
 
       case PROP_CURVE_DATA:
         priv->curve_data = g_value_get_pointer (value);
+        priv->curve_generation += 1;
         break;
 
       default:
@@ -173,6 +194,7 @@ gtk_cifro_curve_object_finalize (GObject *object)
   GtkCifroCurve *ccurve = GTK_CIFRO_CURVE (object);
 
   g_array_unref (ccurve->priv->curve_points);
+  cairo_sdline_commands_free (ccurve->priv->curve_commands);
 
   G_OBJECT_CLASS( gtk_cifro_curve_parent_class )->finalize (object);
 }
@@ -246,6 +268,7 @@ gtk_cifro_curve_visible_draw (GtkWidget *widget,
   GtkCifroCurvePrivate *priv = ccurve->priv;
 
   cairo_sdline_surface *surface;
+  GtkCifroCurveDrawKey key;
 
   guint visible_width;
   guint visible_height;
@@ -262,24 +285,46 @@ gtk_cifro_curve_visible_draw (GtkWidget *widget,
   gtk_cifro_area_get_visible_size (carea, &visible_width, &visible_height);
   gtk_cifro_area_get_border (carea, NULL, NULL, &border_top, NULL);
 
-  /* Рисуем кривую. */
-  for (i = 0; i < visible_width; i++)
+  memset (&key, 0, sizeof (key));
+  gtk_cifro_area_get_view (carea, &key.from_x, &key.to_x, &key.from_y, &key.to_y);
+  key.width = visible_width;
+  key.height = visible_height;
+  key.color = priv->curve_color;
+  key.generation = priv->curve_generation;
+
+  /* Значения кривой рассчитываются заново только при изменении видимой области,
+     цвета или точек кривой, иначе повторно используются записанные команды. */
+  if (memcmp (&key, &priv->curve_key, sizeof (key)) != 0)
     {
-      gtk_cifro_area_visible_point_to_value (carea, i, 0, &x_value, NULL);
-      y_value = priv->curve_func (x_value, priv->curve_points, priv->curve_data);
-      gtk_cifro_area_visible_value_to_point (carea, NULL, &y2, x_value, y_value);
-      y2 = CLAMP (y2, G_MININT32, G_MAXINT32);
+      cairo_sdline_commands_clear (priv->curve_commands);
+      cairo_sdline_surface_set_recording (surface, priv->curve_commands);
 
-      if (i == 0)
+      for (i = 0; i < visible_width; i++)
         {
+          gtk_cifro_area_visible_point_to_value (carea, i, 0, &x_value, NULL);
+          y_value = priv->curve_func (x_value, priv->curve_points, priv->curve_data);
+          gtk_cifro_area_visible_value_to_point (carea, NULL, &y2, x_value, y_value);
+          y2 = CLAMP (y2, G_MININT32, G_MAXINT32);
+
+          if (i == 0)
+            {
+              y1 = y2;
+              continue;
+            }
+
+          cairo_sdline (surface, i - 1, y1, i, y2, priv->curve_color);
           y1 = y2;
-          continue;
         }
 
-      cairo_sdline (surface, i - 1, y1, i, y2, priv->curve_color);
-      y1 = y2;
+      cairo_sdline_surface_set_recording (surface, NULL);
+      priv->curve_key = key;
     }
 
+  /* Рисуем кривую. */
+  cairo_sdline_commands_replay (surface, priv->curve_commands, 1);
+  gtk_cifro_area_add_render_stats (carea, 0, cairo_sdline_commands_get_n_primitives (priv->curve_commands),
+                                   surface->n_pixels);
+
   cairo_surface_mark_dirty (surface->cairo_surface);
   cairo_sdline_set_cairo_color (cairo, priv->point_color);
   cairo_set_line_width (cairo, 1.0);
@@ -288,7 +333,7 @@ gtk_cifro_curve_visible_draw (GtkWidget *widget,
   for (i = 0; i < priv->curve_points->len; i++)
     {
       gdouble x, y;
-      gdouble point_radius = 0.5 * border_top;
+      gdouble point_radius = 0.5 * border_top * gtk_cifro_area_get_visible_scale_factor (carea);
       GtkCifroCurvePoint *point = &g_array_index (priv->curve_points, GtkCifroCurvePoint, i);
 
       gtk_cifro_area_visible_value_to_point (carea, &x, &y, point->x, point->y);
@@ -335,6 +380,7 @@ gtk_cifro_curve_button_press_event (GtkWidget      *widget,
       if (event->state & GDK_CONTROL_MASK)
         {
           g_array_remove_index (priv->curve_points, priv->selected_point);
+          priv->curve_generation += 1;
           priv->selected_point = -1;
         }
       /* Выбрана точка для перемещения. */
@@ -381,7 +427,10 @@ gtk_cifro_curve_button_release_event (GtkWidget      *widget,
 
   /* Обрабатываем удаление точки при её совмещении с другой точкой. */
   if (priv->move_point && priv->remove_point && priv->selected_point >= 0)
-    g_array_remove_index (priv->curve_points, priv->selected_point);
+    {
+      g_array_remove_index (priv->curve_points, priv->selected_point);
+      priv->curve_generation += 1;
+    }
 
   priv->move_point = FALSE;
 
@@ -478,6 +527,7 @@ gtk_cifro_curve_motion_notify_event (GtkWidget      *widget,
   /* Задаём новое положение точки. */
   point->x = value_x;
   point->y = value_y;
+  priv->curve_generation += 1;
 
   return FALSE;
 }
@@ -518,6 +568,7 @@ gtk_cifro_curve_clear_points (GtkCifroCurve *ccurve)
   g_return_if_fail (GTK_IS_CIFRO_CURVE (ccurve));
 
   g_array_set_size (ccurve->priv->curve_points, 0);
+  ccurve->priv->curve_generation += 1;
 
   gtk_widget_queue_draw (GTK_WIDGET (ccurve));
 }
@@ -557,6 +608,7 @@ gtk_cifro_curve_add_point (GtkCifroCurve *ccurve,
   new_point.x = x;
   new_point.y = y;
   g_array_insert_val( priv->curve_points, i, new_point);
+  priv->curve_generation += 1;
 
   gtk_widget_queue_draw (GTK_WIDGET (ccurve));
 }
@@ -583,6 +635,7 @@ gtk_cifro_curve_set_points (GtkCifroCurve *ccurve,
   priv = ccurve->priv;
 
   g_array_set_size (priv->curve_points, 0);
+  priv->curve_generation += 1;
   for (i = 0; i < points->len; i++)
     {
       point = &g_array_index (points, GtkCifroCurvePoint, i);
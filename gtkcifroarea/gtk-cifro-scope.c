@@ -42,38 +42,103 @@
 
 #include "gtk-cifro-scope.h"
 #include "cairo-sdline.h"
+#include "cifro-scope-data.h"
+#include "cifro-area-trace.h"
 
 #include <glib/gprintf.h>
 #include <string.h>
 #include <math.h>
 
+/* Число значений, просматриваемых в одном столбце точек при сниженном качестве изображения. */
+#define FAST_COLUMN_VALUES     64
+#define DRAFT_COLUMN_VALUES    8
+
 enum
 {
   PROP_O,
   PROP_GRAVITY
 };
 
+/* Параметры, от которых зависит изображение осциллограммы канала. */
+typedef struct
+{
+  gdouble                      from_x;                         /* Границы видимой области. */
+  gdouble                      to_x;
+  gdouble                      from_y;
+  gdouble                      to_y;
+  guint                        width;                          /* Размеры видимой области. */
+  guint                        height;
+
+  GtkCifroScopeDrawType        draw_type;                      /* Параметры отображения канала. */
+  guint32                      color;
+  gboolean                     antialias;
+  gdouble                      line_width;
+  gdouble                      time_shift;
+  gdouble                      time_step;
+  gdouble                      value_shift;
+  gdouble                      value_scale;
+  gdouble                      scale_factor;                   /* Число точек поверхности в точке виджета. */
+
+  guint                        generation;                     /* Номер версии данных канала. */
+  GtkCifroAreaQuality          quality;                        /* Качество изображения. */
+} GtkCifroScopeDrawKey;
+
 typedef struct
 {
+  guint                        id;                             /* Идентификатор канала. */
+  gint                         z_order;                        /* Порядок отрисовки канала. */
+
   gchar                       *name;                           /* Имя канала. */
   GtkCifroScopeDrawType        draw_type;                      /* Тип отображения осциллограмм. */
   guint32                      color;                          /* Цвета данных канала. */
   gboolean                     show;                           /* "Выключатели" каналов осциллографа. */
+  gboolean                     antialias;                      /* Сглаживание линий осциллограмм. */
+  gdouble                      line_width;                     /* Толщина линий осциллограмм. */
   gint                         num;                            /* Число данных для отображения. */
 
-  gdouble                      time_shift;                     /* Смещение данных по времени. */
+  gdouble                      user_time_shift;                /* Смещение данных по времени, заданное пользователем. */
+  gdouble                      time_shift;                     /* Смещение данных по времени с учётом синхронизации. */
   gdouble                      time_step;                      /* Шаг времени. */
   gdouble                      value_shift;                    /* Коэффициент смещения данных. */
   gdouble                      value_scale;                    /* Коэффициент масштабирования данных. */
 
   gfloat                      *data;                           /* Данные для отображения. */
   guint                        size;                           /* Размер массива данных для отображения. */
+  cifro_scope_data_summary    *summary;                        /* Сводные данные для поиска, строятся по запросу. */
+
+  gboolean                     stats_valid;                    /* Признак актуальности статистики. */
+  gint64                       stats_from;                     /* Начало диапазона индексов статистики. */
+  gint64                       stats_to;                       /* Конец диапазона индексов статистики. */
+  cifro_scope_data_block       stats_range;                    /* Сводные данные диапазона. */
+  cifro_scope_data_crossings   stats_crossings;                /* Пересечения среднего уровня в диапазоне. */
+
+  guint                        generation;                     /* Номер версии данных, изменяется при их обновлении. */
+  cairo_sdline_commands       *commands;                       /* Записанные команды рисования осциллограммы. */
+  GtkCifroScopeDrawKey         commands_key;                   /* Параметры, для которых записаны команды. */
+  cairo_sdline_surface        *mask;                           /* Маска полупрозрачной осциллограммы. */
 } GtkCifroScopeChannel;
 
+/* Занятость точек столбца области отображения. */
+typedef struct
+{
+  guint32                     *bits;                           /* Битовая карта занятых точек. */
+  gint                         size;                           /* Число точек в столбце. */
+  gint                         x;                              /* Координата X столбца. */
+  gint                         min;                            /* Минимальный индекс занятой точки. */
+  gint                         max;                            /* Максимальный индекс занятой точки. */
+} GtkCifroScopeColumn;
+
 struct _GtkCifroScopePrivate
 {
   GtkCifroScopeGravity         gravity;                        /* Направление осей осциллографа. */
   gboolean                     show_info;                      /* Показывать или нет информацию о значениях под курсором. */
+  gboolean                     show_stats;                     /* Показывать или нет статистику каналов в информационном блоке. */
+  gboolean                     stats_visible;                  /* Статистика по видимой области (TRUE) или по всем данным. */
+
+  gboolean                     autoscale;                      /* Непрерывное автоматическое масштабирование оси значений. */
+  gdouble                      autoscale_margin;               /* Запас по оси значений при масштабировании, доля размаха. */
+  gdouble                      autoscale_from_x;               /* Граница оси времени при последнем масштабировании. */
+  gdouble                      autoscale_to_x;                 /* Граница оси времени при последнем масштабировании. */
   gint32                       next_channel_id;                /* Идентификатор для нового канала. */
 
   gboolean                     swap_x;                         /* Отражение по оси X. */
@@ -91,13 +156,37 @@ struct _GtkCifroScopePrivate
   gdouble                      min_scale_y;                    /* Минимально возможный масштаб (приближение) по оси Y. */
   gdouble                      max_scale_y;                    /* Максимально возможный масштаб (отдаление) по оси Y. */
 
-  GHashTable                  *channels;                       /* Данные каналов осциллографа. */
+  GArray                      *channels;                       /* Данные каналов осциллографа в порядке добавления. */
+  GHashTable                  *channels_index;                 /* Индексы каналов в массиве channels (+1) по идентификатору. */
+  GArray                      *draw_order;                     /* Индексы каналов в порядке отрисовки. */
+
+  guint                        trigger_channel;                /* Идентификатор канала - источника синхронизации. */
+  GtkCifroScopeTriggerType     trigger_type;                   /* Тип синхронизации. */
+  GtkCifroScopeTriggerMode     trigger_mode;                   /* Режим синхронизации. */
+  GtkCifroScopeTriggerState    trigger_state;                  /* Текущее состояние синхронизации. */
+  gdouble                      trigger_level;                  /* Уровень синхронизации. */
+  gdouble                      trigger_hysteresis;             /* Гистерезис уровня синхронизации. */
+  gdouble                      trigger_low;                    /* Нижняя граница окна синхронизации. */
+  gdouble                      trigger_high;                   /* Верхняя граница окна синхронизации. */
+  guint                        trigger_min_width;              /* Минимальная длительность импульса синхронизации. */
+  guint                        trigger_max_width;              /* Максимальная длительность импульса синхронизации. */
+  gdouble                      trigger_position;               /* Доля видимой области до точки синхронизации. */
+  gdouble                      trigger_shift;                  /* Смещение данных по времени для синхронизации. */
+  gboolean                     trigger_hold;                   /* Признак удержания данных до события синхронизации. */
 
   gint                         pointer_x;                      /* Текущее местоположение курсора, X координата. */
   gint                         pointer_y;                      /* Текущее местоположение курсора, Y координата. */
 
   PangoLayout                 *font;                           /* Раскладка шрифта. */
 
+  cairo_sdline_marker         *dot_marker;                     /* Маркер для отображения точками. */
+  cairo_sdline_marker         *dot2_marker;                    /* Маркер для отображения точками увеличенного размера. */
+  cairo_sdline_marker         *cross_marker;                   /* Маркер для отображения перекрестиями. */
+  gdouble                      marker_scale;                   /* Масштаб, для которого созданы маркеры. */
+
+  guint                        render_threads;                 /* Число потоков рисования осциллограмм. */
+  cairo_sdline_commands       *commands;                       /* Команды рисования для многопоточного воспроизведения. */
+
   gchar                       *x_axis_name;                    /* Подпись оси времени. */
   gchar                       *y_axis_name;                    /* Подпись оси значений. */
 
@@ -117,6 +206,86 @@ static void            gtk_cifro_scope_object_finalize         (GObject
 
 static void            gtk_cifro_scope_free_channel            (gpointer                       data);
 
+static GtkCifroScopeChannel *gtk_cifro_scope_get_channel       (GtkCifroScopePrivate          *priv,
+                                                                guint                          channel_id);
+
+static gint            gtk_cifro_scope_compare_order           (gconstpointer                  a,
+                                                                gconstpointer                  b,
+                                                                gpointer                       user_data);
+
+static void            gtk_cifro_scope_update_order            (GtkCifroScopePrivate          *priv);
+
+static void            gtk_cifro_scope_update_markers          (GtkCifroScopePrivate          *priv,
+                                                                gdouble                        scale);
+
+static gboolean        gtk_cifro_scope_convert_levels          (GtkCifroScopeChannel          *channel,
+                                                                cifro_scope_data_predicate    *predicate,
+                                                                gdouble                       *level1,
+                                                                gdouble                       *level2);
+
+static cifro_scope_data_summary *gtk_cifro_scope_get_summary   (GtkCifroScopeChannel          *channel);
+
+static gint64          gtk_cifro_scope_search_value            (GtkCifroScopeChannel          *channel,
+                                                                gint64                         from,
+                                                                gboolean                       forward,
+                                                                cifro_scope_data_predicate     predicate,
+                                                                gdouble                        level1,
+                                                                gdouble                        level2);
+
+static gint64          gtk_cifro_scope_search_run              (GtkCifroScopeChannel          *channel,
+                                                                gint64                         from,
+                                                                gboolean                       forward,
+                                                                cifro_scope_data_predicate     in_predicate,
+                                                                cifro_scope_data_predicate     out_predicate,
+                                                                gdouble                        level);
+
+static gint64          gtk_cifro_scope_search_glitch           (GtkCifroScopeChannel          *channel,
+                                                                gint64                         from,
+                                                                gboolean                       forward,
+                                                                cifro_scope_data_predicate     in_predicate,
+                                                                cifro_scope_data_predicate     out_predicate,
+                                                                gdouble                        level,
+                                                                guint                          width);
+
+static gboolean        gtk_cifro_scope_visible_range           (GtkCifroArea                  *carea,
+                                                                GtkCifroScopeChannel          *channel,
+                                                                gint64                        *from,
+                                                                gint64                        *to);
+
+static gboolean        gtk_cifro_scope_autoscale_range         (GtkCifroScope                 *cscope,
+                                                                gdouble                       *min_y,
+                                                                gdouble                       *max_y);
+
+static void            gtk_cifro_scope_autoscale_apply         (GtkCifroScope                 *cscope);
+
+static gboolean        gtk_cifro_scope_channel_stats           (GtkCifroArea                  *carea,
+                                                                GtkCifroScopeChannel          *channel,
+                                                                gboolean                       visible_only,
+                                                                GtkCifroScopeStats            *stats);
+
+static gint64          gtk_cifro_scope_find_value              (GtkCifroScopeChannel          *channel,
+                                                                const gfloat                  *data,
+                                                                gint64                         from,
+                                                                gint64                         to,
+                                                                cifro_scope_data_predicate     predicate,
+                                                                gdouble                        level1,
+                                                                gdouble                        level2);
+
+static gboolean        gtk_cifro_scope_trigger_find            (GtkCifroScopePrivate          *priv,
+                                                                GtkCifroScopeChannel          *channel,
+                                                                const gfloat                  *data,
+                                                                gint64                         n_values,
+                                                                gint64                         start,
+                                                                gdouble                       *position);
+
+static void            gtk_cifro_scope_trigger_set_shift       (GtkCifroScopePrivate          *priv,
+                                                                gdouble                        shift);
+
+static gboolean        gtk_cifro_scope_trigger_update          (GtkCifroScope                 *cscope,
+                                                                GtkCifroScopeChannel          *channel,
+                                                                guint                          n_values,
+                                                                const gfloat                  *values);
+
 static gboolean        gtk_cifro_scope_get_rotate              (GtkCifroArea                  *carea);
 
 static void            gtk_cifro_scope_get_swap                (GtkCifroArea                  *carea,
@@ -153,22 +322,45 @@ static void            gtk_cifro_scope_draw_x_pos              (GtkWidget
                                                                 cairo_t                       *cairo);
 static void            gtk_cifro_scope_draw_y_pos              (GtkWidget                     *widget,
                                                                 cairo_t                       *cairo);
+static void            gtk_cifro_scope_format_stats            (const gchar                   *name,
+                                                                GtkCifroScopeStats            *stats,
+                                                                guint                          row,
+                                                                gchar                         *text,
+                                                                gsize                          size);
+
 static void            gtk_cifro_scope_draw_info               (GtkWidget                     *widget,
                                                                 cairo_t                       *cairo);
 
 static void            gtk_cifro_scope_draw_axis               (GtkWidget                     *widget,
                                                                 cairo_sdline_surface          *surface);
-static void            gtk_cifro_scope_draw_lined_data         (GtkWidget                     *widget,
+static void            gtk_cifro_scope_draw_segment            (cairo_sdline_surface          *surface,
+                                                                GtkCifroScopeChannel          *channel,
+                                                                gdouble                        line_width,
+                                                                gdouble                        x1,
+                                                                gdouble                        y1,
+                                                                gdouble                        x2,
+                                                                gdouble                        y2);
+
+static guint64         gtk_cifro_scope_draw_lined_data         (GtkWidget                     *widget,
                                                                 cairo_sdline_surface          *surface,
-                                                                gpointer                       channel_id);
-static void            gtk_cifro_scope_draw_dotted_data        (GtkWidget                     *widget,
+                                                                GtkCifroScopeChannel          *channel,
+                                                                gint                           column_values);
+static void            gtk_cifro_scope_column_init             (GtkCifroScopeColumn           *column,
+                                                                gint                           size);
+
+static gboolean        gtk_cifro_scope_column_mark             (GtkCifroScopeColumn           *column,
+                                                                gint                           x,
+                                                                gint                           y);
+
+static guint64         gtk_cifro_scope_draw_marked_data        (GtkWidget                     *widget,
                                                                 cairo_sdline_surface          *surface,
-                                                                gpointer                       channel_id,
-                                                                guint                          size);
-static void            gtk_cifro_scope_draw_crossed_data       (GtkWidget                     *widget,
+                                                                GtkCifroScopeChannel          *channel,
+                                                                cairo_sdline_marker           *marker,
+                                                                gint                           column_values);
+
+static void            gtk_cifro_scope_draw_channel            (GtkWidget                     *widget,
                                                                 cairo_sdline_surface          *surface,
-                                                                gpointer                       channel_id,
-                                                                guint                          size);
+                                                                GtkCifroScopeChannel          *channel);
 
 static void            gtk_cifro_scope_area_draw               (GtkWidget                     *widget,
                                                                 cairo_t                       *cairo);
@@ -177,6 +369,7 @@ static void            gtk_cifro_scope_visible_draw            (GtkWidget
 
 static gboolean        gtk_cifro_scope_configure               (GtkWidget                     *widget,
                                                                 GdkEventConfigure             *event);
+static void            gtk_cifro_scope_view_changed            (GtkWidget                     *widget);
 static gboolean        gtk_cifro_scope_motion_notify           (GtkWidget                     *widget,
                                                                 GdkEventMotion                *event);
 static gboolean        gtk_cifro_scope_leave_notify            (GtkWidget                     *widget,
@@ -318,8 +511,26 @@ gtk_cifro_scope_object_constructed (GObject *object)
   priv->y_axis_name = g_strdup ("Y");
 
   /* Каналы осциллографа. */
-  priv->channels = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
-                                          gtk_cifro_scope_free_channel);
+  priv->channels = g_array_new (FALSE, TRUE, sizeof (GtkCifroScopeChannel));
+  g_array_set_clear_func (priv->channels, gtk_cifro_scope_free_channel);
+  priv->channels_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->draw_order = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  /* Параметры синхронизации по умолчанию. */
+  priv->trigger_type = GTK_CIFRO_SCOPE_TRIGGER_NONE;
+  priv->trigger_mode = GTK_CIFRO_SCOPE_TRIGGER_AUTO;
+  priv->trigger_state = GTK_CIFRO_SCOPE_TRIGGER_FREE_RUN;
+  priv->trigger_position = 0.5;
+
+  /* Маркеры для отображения данных. */
+  gtk_cifro_scope_update_markers (priv, 1.0);
+
+  /* Осциллограммы рисуются в одном потоке. */
+  priv->render_threads = 1;
+  priv->commands = cairo_sdline_commands_new ();
+
+  /* Запас по оси значений при автоматическом масштабировании. */
+  priv->autoscale_margin = 0.05;
 
   /* Координаты информационной точки. */
   priv->pointer_x = -1;
@@ -329,6 +540,7 @@ gtk_cifro_scope_object_constructed (GObject *object)
   g_signal_connect (cscope, "area-draw", G_CALLBACK (gtk_cifro_scope_area_draw), NULL);
   g_signal_connect (cscope, "visible-draw", G_CALLBACK (gtk_cifro_scope_visible_draw), NULL);
   g_signal_connect (cscope, "configure-event", G_CALLBACK (gtk_cifro_scope_configure), NULL);
+  g_signal_connect (cscope, "view-changed", G_CALLBACK (gtk_cifro_scope_view_changed), NULL);
   g_signal_connect (cscope, "motion-notify-event", G_CALLBACK (gtk_cifro_scope_motion_notify), NULL);
   g_signal_connect (cscope, "leave-notify-event", G_CALLBACK (gtk_cifro_scope_leave_notify), NULL);
 
@@ -347,7 +559,13 @@ gtk_cifro_scope_object_finalize (GObject *object)
   GtkCifroScopePrivate *priv = cscope->priv;
 
   g_clear_pointer (&priv->font, g_object_unref);
-  g_hash_table_unref (priv->channels);
+  cairo_sdline_marker_destroy (priv->dot_marker);
+  cairo_sdline_marker_destroy (priv->dot2_marker);
+  cairo_sdline_marker_destroy (priv->cross_marker);
+  cairo_sdline_commands_free (priv->commands);
+  g_array_unref (priv->channels);
+  g_hash_table_unref (priv->channels_index);
+  g_array_unref (priv->draw_order);
 
   g_free (priv->x_axis_name);
   g_free (priv->y_axis_name);
@@ -355,7 +573,7 @@ gtk_cifro_scope_object_finalize (GObject *object)
   G_OBJECT_CLASS (gtk_cifro_scope_parent_class)->finalize (object);
 }
 
-/* Функция удаляет структуру с данными канала. */
+/* Функция освобождает данные канала. */
 static void
 gtk_cifro_scope_free_channel (gpointer data)
 {
@@ -364,9 +582,83 @@ gtk_cifro_scope_free_channel (gpointer data)
   if (channel == NULL)
     return;
 
+  cifro_scope_data_summary_free (channel->summary);
+  cairo_sdline_commands_free (channel->commands);
+  cairo_sdline_surface_destroy (channel->mask);
   g_free (channel->data);
   g_free (channel->name);
-  g_free (channel);
+}
+
+/* Функция возвращает канал по его идентификатору. */
+static GtkCifroScopeChannel *
+gtk_cifro_scope_get_channel (GtkCifroScopePrivate *priv,
+                             guint                 channel_id)
+{
+  guint index;
+
+  index = GPOINTER_TO_UINT (g_hash_table_lookup (priv->channels_index, GUINT_TO_POINTER (channel_id)));
+  if (index == 0)
+    return NULL;
+
+  return &g_array_index (priv->channels, GtkCifroScopeChannel, index - 1);
+}
+
+/* Функция сравнения каналов для определения порядка отрисовки. */
+static gint
+gtk_cifro_scope_compare_order (gconstpointer a,
+                               gconstpointer b,
+                               gpointer      user_data)
+{
+  GArray *channels = user_data;
+  guint index1 = *(const guint*)a;
+  guint index2 = *(const guint*)b;
+  GtkCifroScopeChannel *channel1 = &g_array_index (channels, GtkCifroScopeChannel, index1);
+  GtkCifroScopeChannel *channel2 = &g_array_index (channels, GtkCifroScopeChannel, index2);
+
+  if (channel1->z_order != channel2->z_order)
+    return (channel1->z_order < channel2->z_order) ? -1 : 1;
+
+  return (index1 < index2) ? -1 : (index1 > index2);
+}
+
+/* Функция обновляет индексы каналов и порядок их отрисовки. */
+static void
+gtk_cifro_scope_update_order (GtkCifroScopePrivate *priv)
+{
+  guint i;
+
+  g_hash_table_remove_all (priv->channels_index);
+  g_array_set_size (priv->draw_order, priv->channels->len);
+
+  for (i = 0; i < priv->channels->len; i++)
+    {
+      GtkCifroScopeChannel *channel = &g_array_index (priv->channels, GtkCifroScopeChannel, i);
+
+      g_hash_table_insert (priv->channels_index, GUINT_TO_POINTER (channel->id), GUINT_TO_POINTER (i + 1));
+      g_array_index (priv->draw_order, guint, i) = i;
+    }
+
+  g_array_sort_with_data (priv->draw_order, gtk_cifro_scope_compare_order, priv->channels);
+}
+
+/* Функция создаёт маркеры для отображения данных. Размеры маркеров заданы в точках
+   виджета и пересчитываются в точки поверхности видимой области с масштабом scale. */
+static void
+gtk_cifro_scope_update_markers (GtkCifroScopePrivate *priv,
+                                gdouble               scale)
+{
+  if ((priv->dot_marker != NULL) && (priv->marker_scale == scale))
+    return;
+
+  cairo_sdline_marker_destroy (priv->dot_marker);
+  cairo_sdline_marker_destroy (priv->dot2_marker);
+  cairo_sdline_marker_destroy (priv->cross_marker);
+
+  /* Маркер радиусом r занимает 2r + 1 точек, масштабируется этот размер. */
+  priv->dot_marker = cairo_sdline_marker_create (CAIRO_SDLINE_MARKER_SQUARE, floor (0.5 * scale));
+  priv->dot2_marker = cairo_sdline_marker_create (CAIRO_SDLINE_MARKER_SQUARE, floor (1.5 * scale));
+  priv->cross_marker = cairo_sdline_marker_create (CAIRO_SDLINE_MARKER_CROSS, floor (3.5 * scale));
+  priv->marker_scale = scale;
 }
 
 /* Виртуальная функция для определения разрешения поворота изображения. */
@@ -450,6 +742,503 @@ gtk_cifro_scope_check_scale (GtkCifroArea *carea,
   *scale_y = CLAMP (*scale_y, priv->min_scale_y, priv->max_scale_y);
 }
 
+/* Функция пересчитывает уровни из единиц оси значений в исходные значения канала
+   с учётом масштаба и смещения. При отрицательном масштабе условие меняется на обратное. */
+static gboolean
+gtk_cifro_scope_convert_levels (GtkCifroScopeChannel       *channel,
+                                cifro_scope_data_predicate *predicate,
+                                gdouble                    *level1,
+                                gdouble                    *level2)
+{
+  gdouble swap;
+
+  if (channel->value_scale == 0.0)
+    return FALSE;
+
+  *level1 = (*level1 - channel->value_shift) / channel->value_scale;
+  *level2 = (*level2 - channel->value_shift) / channel->value_scale;
+
+  if (channel->value_scale < 0.0)
+    {
+      switch (*predicate)
+        {
+        case CIFRO_SCOPE_DATA_ABOVE:
+          *predicate = CIFRO_SCOPE_DATA_BELOW;
+          break;
+        case CIFRO_SCOPE_DATA_BELOW:
+          *predicate = CIFRO_SCOPE_DATA_ABOVE;
+          break;
+        case CIFRO_SCOPE_DATA_NOT_ABOVE:
+          *predicate = CIFRO_SCOPE_DATA_NOT_BELOW;
+          break;
+        case CIFRO_SCOPE_DATA_NOT_BELOW:
+          *predicate = CIFRO_SCOPE_DATA_NOT_ABOVE;
+          break;
+        case CIFRO_SCOPE_DATA_INSIDE:
+        case CIFRO_SCOPE_DATA_OUTSIDE:
+          swap = *level1;
+          *level1 = *level2;
+          *level2 = swap;
+          break;
+        default:
+          break;
+        }
+    }
+
+  return TRUE;
+}
+
+/* Функция возвращает сводные данные канала, при необходимости строит их. */
+static cifro_scope_data_summary *
+gtk_cifro_scope_get_summary (GtkCifroScopeChannel *channel)
+{
+  if (channel->summary == NULL)
+    channel->summary = cifro_scope_data_summary_new (channel->data, channel->num);
+
+  return channel->summary;
+}
+
+/* Функция ищет значение в данных канала с использованием сводных данных. */
+static gint64
+gtk_cifro_scope_search_value (GtkCifroScopeChannel       *channel,
+                              gint64                      from,
+                              gboolean                    forward,
+                              cifro_scope_data_predicate  predicate,
+                              gdouble                     level1,
+                              gdouble                     level2)
+{
+  if ((from < 0) || (from >= channel->num))
+    return -1;
+
+  if (!gtk_cifro_scope_convert_levels (channel, &predicate, &level1, &level2))
+    return -1;
+
+  return cifro_scope_data_summary_find (gtk_cifro_scope_get_summary (channel), channel->data,
+                                        from, forward, predicate, level1, level2);
+}
+
+/* Функция ищет начало следующего (или предыдущего) участка данных, на котором
+   выполняется условие in_predicate. Участок, содержащий индекс from, пропускается. */
+static gint64
+gtk_cifro_scope_search_run (GtkCifroScopeChannel       *channel,
+                            gint64                      from,
+                            gboolean                    forward,
+                            cifro_scope_data_predicate  in_predicate,
+                            cifro_scope_data_predicate  out_predicate,
+                            gdouble                     level)
+{
+  gint64 i = from;
+
+  if (gtk_cifro_scope_search_value (channel, i, forward, in_predicate, level, 0.0) == i)
+    i = gtk_cifro_scope_search_value (channel, i, forward, out_predicate, level, 0.0);
+
+  i = gtk_cifro_scope_search_value (channel, i, forward, in_predicate, level, 0.0);
+  if ((i < 0) || forward)
+    return i;
+
+  /* При поиске назад находим начало участка. */
+  i = gtk_cifro_scope_search_value (channel, i, FALSE, out_predicate, level, 0.0);
+
+  return i + 1;
+}
+
+/* Функция ищет участок данных, на котором выполняется условие in_predicate, длиной
+   меньше width отсчётов и ограниченный с обеих сторон значениями с условием out_predicate. */
+static gint64
+gtk_cifro_scope_search_glitch (GtkCifroScopeChannel       *channel,
+                               gint64                      from,
+                               gboolean                    forward,
+                               cifro_scope_data_predicate  in_predicate,
+                               cifro_scope_data_predicate  out_predicate,
+                               gdouble                     level,
+                               guint                       width)
+{
+  gint64 begin, end;
+  gint64 i = from;
+
+  while (TRUE)
+    {
+      begin = gtk_cifro_scope_search_run (channel, i, forward, in_predicate, out_predicate, level);
+      if (begin < 0)
+        return -1;
+
+      /* Участок, не ограниченный справа, глитчем не считается. */
+      end = gtk_cifro_scope_search_value (channel, begin, TRUE, out_predicate, level, 0.0);
+      if ((end < 0) && forward)
+        return -1;
+
+      if ((begin > 0) && (end > 0) && ((end - begin) < width))
+        return begin;
+
+      i = forward ? end : begin - 1;
+    }
+}
+
+/* Функция вычисляет диапазон индексов [from, to) значений канала в видимой области. */
+static gboolean
+gtk_cifro_scope_visible_range (GtkCifroArea         *carea,
+                               GtkCifroScopeChannel *channel,
+                               gint64               *from,
+                               gint64               *to)
+{
+  gdouble from_x, to_x;
+
+  if ((channel->num <= 0) || (channel->time_step <= 0.0))
+    return FALSE;
+
+  gtk_cifro_area_get_view (carea, &from_x, &to_x, NULL, NULL);
+
+  *from = MAX (0, (gint64) ceil ((from_x - channel->time_shift) / channel->time_step));
+  *to = MIN (channel->num, (gint64) floor ((to_x - channel->time_shift) / channel->time_step) + 1);
+
+  return (*from < *to);
+}
+
+/* Функция вычисляет диапазон значений видимых каналов в видимой области. */
+static gboolean
+gtk_cifro_scope_autoscale_range (GtkCifroScope *cscope,
+                                 gdouble       *min_y,
+                                 gdouble       *max_y)
+{
+  GtkCifroScopePrivate *priv = cscope->priv;
+  GtkCifroScopeChannel *channel;
+  cifro_scope_data_block range;
+  gboolean found = FALSE;
+  gdouble value_min, value_max;
+  gfloat min, max;
+  gint64 from, to;
+  guint i;
+
+  for (i = 0; i < priv->channels->len; i++)
+    {
+      channel = &g_array_index (priv->channels, GtkCifroScopeChannel, i);
+      if (!channel->show || !gtk_cifro_scope_visible_range (GTK_CIFRO_AREA (cscope), channel, &from, &to))
+        continue;
+
+      /* Сводные данные строятся один раз и обновляются вместе с данными канала,
+         поэтому диапазон определяется за время O(log N). */
+      cifro_scope_data_summary_range (gtk_cifro_scope_get_summary (channel), channel->data, from, to, &range);
+      min = range.min;
+      max = range.max;
+
+      /* В диапазоне только NaN. */
+      if (min > max)
+        continue;
+
+      value_min = (channel->value_scale > 0.0 ? min : max) * channel->value_scale + channel->value_shift;
+      value_max = (channel->value_scale > 0.0 ? max : min) * channel->value_scale + channel->value_shift;
+
+      *min_y = found ? MIN (*min_y, value_min) : value_min;
+      *max_y = found ? MAX (*max_y, value_max) : value_max;
+      found = TRUE;
+    }
+
+  return found;
+}
+
+/* Функция устанавливает границы оси значений по диапазону видимых данных. */
+static void
+gtk_cifro_scope_autoscale_apply (GtkCifroScope *cscope)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (cscope);
+  GtkCifroScopePrivate *priv = cscope->priv;
+  gdouble from_x, to_x, from_y, to_y;
+  gdouble min_y, max_y;
+  gdouble margin;
+
+  gtk_cifro_area_get_view (carea, &from_x, &to_x, &from_y, &to_y);
+  priv->autoscale_from_x = from_x;
+  priv->autoscale_to_x = to_x;
+
+  if (!gtk_cifro_scope_autoscale_range (cscope, &min_y, &max_y))
+    return;
+
+  /* Постоянный сигнал размещается посередине области. */
+  if (max_y > min_y)
+    margin = (max_y - min_y) * priv->autoscale_margin;
+  else
+    margin = (max_y != 0.0) ? fabs (max_y) / 2.0 : 1.0;
+
+  min_y = MAX (min_y - margin, priv->min_y);
+  max_y = MIN (max_y + margin, priv->max_y);
+  if ((min_y >= max_y) || ((min_y == from_y) && (max_y == to_y)))
+    return;
+
+  gtk_cifro_area_set_view (carea, from_x, to_x, min_y, max_y);
+}
+
+/* Функция вычисляет статистику канала по видимой области или по всем данным. */
+static gboolean
+gtk_cifro_scope_channel_stats (GtkCifroArea         *carea,
+                               GtkCifroScopeChannel *channel,
+                               gboolean              visible_only,
+                               GtkCifroScopeStats   *stats)
+{
+  cifro_scope_data_block *range = &channel->stats_range;
+  cifro_scope_data_crossings *crossings = &channel->stats_crossings;
+  gdouble scale = channel->value_scale;
+  gdouble shift = channel->value_shift;
+  gdouble mean, mean2;
+  gint64 from, to;
+  gint64 n_values;
+
+  if ((channel->num <= 0) || (channel->time_step <= 0.0))
+    return FALSE;
+
+  /* Диапазон индексов значений. */
+  from = 0;
+  to = channel->num;
+  if (visible_only && !gtk_cifro_scope_visible_range (carea, channel, &from, &to))
+    return FALSE;
+
+  /* Сводные данные диапазона и пересечения уровня посередине между минимумом
+     и максимумом с гистерезисом 5% от размаха. */
+  if (!channel->stats_valid || (channel->stats_from != from) || (channel->stats_to != to))
+    {
+      cifro_scope_data_summary *summary = gtk_cifro_scope_get_summary (channel);
+
+      cifro_scope_data_summary_range (summary, channel->data, from, to, range);
+      if (range->n_nan < to - from)
+        {
+          cifro_scope_data_summary_crossings (summary, channel->data, from, to,
+                                              (range->min + range->max) / 2.0,
+                                              (range->max - range->min) * 0.05,
+                                              crossings);
+        }
+
+      channel->stats_valid = TRUE;
+      channel->stats_from = from;
+      channel->stats_to = to;
+    }
+
+  n_values = (to - from) - range->n_nan;
+  if (n_values == 0)
+    return FALSE;
+
+  /* Пересчёт в единицы оси значений. */
+  mean = range->sum / n_values;
+  mean2 = range->sum2 / n_values;
+
+  stats->min = (scale > 0.0 ? range->min : range->max) * scale + shift;
+  stats->max = (scale > 0.0 ? range->max : range->min) * scale + shift;
+  stats->mean = mean * scale + shift;
+  stats->rms = sqrt (MAX (0.0, scale * scale * mean2 + 2.0 * scale * shift * mean + shift * shift));
+  stats->peak_to_peak = stats->max - stats->min;
+  stats->n_values = n_values;
+
+  stats->frequency = 0.0;
+  if (crossings->n_rising > 1)
+    {
+      stats->frequency = (crossings->n_rising - 1) /
+                         ((crossings->last_rising - crossings->first_rising) * channel->time_step);
+    }
+
+  stats->duty_cycle = (gdouble) crossings->n_above / n_values;
+  if (scale < 0.0)
+    stats->duty_cycle = 1.0 - stats->duty_cycle;
+
+  return TRUE;
+}
+
+/* Функция ищет значение канала в массиве data, удовлетворяющее условию. */
+static gint64
+gtk_cifro_scope_find_value (GtkCifroScopeChannel       *channel,
+                            const gfloat               *data,
+                            gint64                      from,
+                            gint64                      to,
+                            cifro_scope_data_predicate  predicate,
+                            gdouble                     level1,
+                            gdouble                     level2)
+{
+  if (!gtk_cifro_scope_convert_levels (channel, &predicate, &level1, &level2))
+    return -1;
+
+  return cifro_scope_data_find (data, from, to, predicate, level1, level2);
+}
+
+/* Функция ищет событие синхронизации в данных канала начиная с индекса start.
+   Найденная точка синхронизации возвращается в виде дробного индекса. */
+static gboolean
+gtk_cifro_scope_trigger_find (GtkCifroScopePrivate *priv,
+                              GtkCifroScopeChannel *channel,
+                              const gfloat         *data,
+                              gint64                n_values,
+                              gint64                start,
+                              gdouble              *position)
+{
+  cifro_scope_data_predicate arm_predicate;
+  cifro_scope_data_predicate fire_predicate;
+  cifro_scope_data_predicate end_predicate;
+  gdouble arm_level1, arm_level2;
+  gdouble fire_level1, fire_level2;
+  gdouble end_level;
+
+  gdouble level = priv->trigger_level;
+  gdouble hysteresis = fabs (priv->trigger_hysteresis);
+  gdouble value1, value2;
+
+  gint64 arm, fire, end;
+  gint64 i = 0;
+
+  arm_level2 = fire_level2 = 0.0;
+  end_predicate = CIFRO_SCOPE_DATA_ABOVE;
+  end_level = 0.0;
+
+  /* Условия взвода синхронизации, её срабатывания и окончания импульса. */
+  switch (priv->trigger_type)
+    {
+    case GTK_CIFRO_SCOPE_TRIGGER_RISING:
+    case GTK_CIFRO_SCOPE_TRIGGER_PULSE_HIGH:
+      arm_predicate = CIFRO_SCOPE_DATA_BELOW;
+      arm_level1 = level - hysteresis;
+      fire_predicate = CIFRO_SCOPE_DATA_ABOVE;
+      fire_level1 = level;
+      end_predicate = CIFRO_SCOPE_DATA_BELOW;
+      end_level = level - hysteresis;
+      break;
+
+    case GTK_CIFRO_SCOPE_TRIGGER_FALLING:
+    case GTK_CIFRO_SCOPE_TRIGGER_PULSE_LOW:
+      arm_predicate = CIFRO_SCOPE_DATA_ABOVE;
+      arm_level1 = level + hysteresis;
+      fire_predicate = CIFRO_SCOPE_DATA_BELOW;
+      fire_level1 = level;
+      end_predicate = CIFRO_SCOPE_DATA_ABOVE;
+      end_level = level + hysteresis;
+      break;
+
+    case GTK_CIFRO_SCOPE_TRIGGER_WINDOW:
+      arm_predicate = CIFRO_SCOPE_DATA_INSIDE;
+      arm_level1 = priv->trigger_low + hysteresis;
+      arm_level2 = priv->trigger_high - hysteresis;
+      fire_predicate = CIFRO_SCOPE_DATA_OUTSIDE;
+      fire_level1 = priv->trigger_low;
+      fire_level2 = priv->trigger_high;
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  while (i < n_values)
+    {
+      arm = gtk_cifro_scope_find_value (channel, data, i, n_values, arm_predicate, arm_level1, arm_level2);
+      if (arm < 0)
+        return FALSE;
+
+      fire = gtk_cifro_scope_find_value (channel, data, arm + 1, n_values, fire_predicate, fire_level1, fire_level2);
+      if (fire < 0)
+        return FALSE;
+
+      /* Синхронизация по длительности импульса срабатывает по его окончанию. */
+      if ((priv->trigger_type == GTK_CIFRO_SCOPE_TRIGGER_PULSE_HIGH) ||
+          (priv->trigger_type == GTK_CIFRO_SCOPE_TRIGGER_PULSE_LOW))
+        {
+          end = gtk_cifro_scope_find_value (channel, data, fire + 1, n_values, end_predicate, end_level, 0.0);
+          if (end < 0)
+            return FALSE;
+
+          i = end;
+          if ((end < start) || ((end - fire) < priv->trigger_min_width))
+            continue;
+          if ((priv->trigger_max_width > 0) && ((end - fire) > priv->trigger_max_width))
+            continue;
+
+          *position = end;
+          return TRUE;
+        }
+
+      i = fire;
+      if (fire < start)
+        continue;
+
+      /* Уточняем точку пересечения уровня линейной интерполяцией. */
+      *position = fire;
+      if ((priv->trigger_type != GTK_CIFRO_SCOPE_TRIGGER_WINDOW) && (fire > 0))
+        {
+          value1 = (data[fire - 1] * channel->value_scale) + channel->value_shift;
+          value2 = (data[fire] * channel->value_scale) + channel->value_shift;
+          if (!isnan (value1) && (value1 != value2))
+            *position = (fire - 1) + CLAMP ((level - value1) / (value2 - value1), 0.0, 1.0);
+        }
+
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Функция устанавливает смещение данных всех каналов по времени для синхронизации. */
+static void
+gtk_cifro_scope_trigger_set_shift (GtkCifroScopePrivate *priv,
+                                   gdouble               shift)
+{
+  GtkCifroScopeChannel *channel;
+  guint i;
+
+  priv->trigger_shift = shift;
+
+  for (i = 0; i < priv->channels->len; i++)
+    {
+      channel = &g_array_index (priv->channels, GtkCifroScopeChannel, i);
+      channel->time_shift = channel->user_time_shift + shift;
+    }
+}
+
+/* Функция обрабатывает новые данные канала - источника синхронизации.
+   Возвращает TRUE если данные необходимо отобразить. */
+static gboolean
+gtk_cifro_scope_trigger_update (GtkCifroScope        *cscope,
+                                GtkCifroScopeChannel *channel,
+                                guint                 n_values,
+                                const gfloat         *values)
+{
+  GtkCifroScopePrivate *priv = cscope->priv;
+
+  gdouble from_x;
+  gdouble to_x;
+  gdouble trigger_x;
+  gdouble position;
+  gint64 start;
+
+  /* Данные однократного запуска удерживаются до повторного взвода. */
+  if (priv->trigger_state == GTK_CIFRO_SCOPE_TRIGGER_STOPPED)
+    return FALSE;
+
+  if ((priv->trigger_mode == GTK_CIFRO_SCOPE_TRIGGER_SINGLE) &&
+      (priv->trigger_state == GTK_CIFRO_SCOPE_TRIGGER_TRIGGERED))
+    {
+      priv->trigger_state = GTK_CIFRO_SCOPE_TRIGGER_STOPPED;
+      return FALSE;
+    }
+
+  /* Точка синхронизации размещается на заданной доле видимой области,
+     поиск начинается с индекса, данные до которого заполняют эту долю. */
+  gtk_cifro_area_get_view (GTK_CIFRO_AREA (cscope), &from_x, &to_x, NULL, NULL);
+  trigger_x = from_x + priv->trigger_position * (to_x - from_x);
+  start = 0;
+  if (channel->time_step > 0.0)
+    start = CLAMP (ceil (priv->trigger_position * (to_x - from_x) / channel->time_step), 0, n_values);
+
+  if (gtk_cifro_scope_trigger_find (priv, channel, values, n_values, start, &position))
+    {
+      priv->trigger_state = GTK_CIFRO_SCOPE_TRIGGER_TRIGGERED;
+      gtk_cifro_scope_trigger_set_shift (priv, trigger_x - (channel->user_time_shift + position * channel->time_step));
+      return TRUE;
+    }
+
+  if (priv->trigger_mode == GTK_CIFRO_SCOPE_TRIGGER_AUTO)
+    {
+      priv->trigger_state = GTK_CIFRO_SCOPE_TRIGGER_FREE_RUN;
+      gtk_cifro_scope_trigger_set_shift (priv, 0.0);
+      return TRUE;
+    }
+
+  priv->trigger_state = GTK_CIFRO_SCOPE_TRIGGER_WAIT;
+
+  return FALSE;
+}
+
 /* Функция устанавливает основной цвет для отображения графических элементов в осциллографе. */
 static void
 gtk_cifro_scope_set_fg_color (GtkCifroScopePrivate *priv,
@@ -982,6 +1771,36 @@ gtk_cifro_scope_draw_y_pos (GtkWidget *widget,
   cairo_fill (cairo);
 }
 
+/* Функция формирует строку статистики канала для информационного блока. */
+static void
+gtk_cifro_scope_format_stats (const gchar        *name,
+                              GtkCifroScopeStats *stats,
+                              guint               row,
+                              gchar              *text,
+                              gsize               size)
+{
+  gchar value1[G_ASCII_DTOSTR_BUF_SIZE];
+  gchar value2[G_ASCII_DTOSTR_BUF_SIZE];
+  gchar value3[G_ASCII_DTOSTR_BUF_SIZE];
+  gchar value4[G_ASCII_DTOSTR_BUF_SIZE];
+
+  if (row == 0)
+    {
+      g_ascii_formatd (value1, sizeof(value1), "%.4g", stats->min);
+      g_ascii_formatd (value2, sizeof(value2), "%.4g", stats->max);
+      g_ascii_formatd (value3, sizeof(value3), "%.4g", stats->peak_to_peak);
+      g_snprintf (text, size, "%s: min %s  max %s  p-p %s", name, value1, value2, value3);
+    }
+  else
+    {
+      g_ascii_formatd (value1, sizeof(value1), "%.4g", stats->mean);
+      g_ascii_formatd (value2, sizeof(value2), "%.4g", stats->rms);
+      g_ascii_formatd (value3, sizeof(value3), "%.4g", stats->frequency);
+      g_ascii_formatd (value4, sizeof(value4), "%.1f", 100.0 * stats->duty_cycle);
+      g_snprintf (text, size, "mean %s  rms %s  f %s  D %s%%", value1, value2, value3, value4);
+    }
+}
+
 /* Рисование информационного блока. */
 static void
 gtk_cifro_scope_draw_info (GtkWidget *widget,
@@ -991,8 +1810,9 @@ gtk_cifro_scope_draw_info (GtkWidget *widget,
   GtkCifroScope *cscope = GTK_CIFRO_SCOPE (widget);
   GtkCifroScopePrivate *priv = cscope->priv;
 
-  GHashTableIter channels_iter;
   GtkCifroScopeChannel *channel;
+  GtkCifroScopeStats stats;
+  guint i, j;
 
   PangoLayout *font = priv->font;
 
@@ -1008,9 +1828,11 @@ gtk_cifro_scope_draw_info (GtkWidget *widget,
   gdouble to_y;
 
   guint n_labels;
+  guint n_stats;
 
   gint mark_width;
   gint label_width;
+  gint stats_width;
   gint font_height;
 
   gint info_center;
@@ -1060,9 +1882,9 @@ gtk_cifro_scope_draw_info (GtkWidget *widget,
 
   n_labels = 2;
   label_width = 0;
-  g_hash_table_iter_init (&channels_iter, priv->channels);
-  while (g_hash_table_iter_next (&channels_iter, NULL, (gpointer) &channel))
+  for (i = 0; i < priv->channels->len; i++)
     {
+      channel = &g_array_index (priv->channels, GtkCifroScopeChannel, i);
       if ((channel->value_scale == 1.0) && (channel->name == NULL) && (label_width != 0))
         continue;
 
@@ -1110,16 +1932,44 @@ gtk_cifro_scope_draw_info (GtkWidget *widget,
   if (text_height > font_height)
     font_height = text_height;
 
+  /* Статистика видимых каналов, по две строки на канал. */
+  n_stats = 0;
+  stats_width = 0;
+  for (i = 0; priv->show_stats && (i < priv->channels->len); i++)
+    {
+      channel = &g_array_index (priv->channels, GtkCifroScopeChannel, i);
+      if (!channel->show || !gtk_cifro_scope_channel_stats (carea, channel, priv->stats_visible, &stats))
+        continue;
+
+      for (j = 0; j < 2; j++)
+        {
+          gtk_cifro_scope_format_stats (channel->name != NULL ? channel->name : priv->y_axis_name,
+                                        &stats, j, text_str, sizeof(text_str));
+          pango_layout_set_text (font, text_str, -1);
+          pango_layout_get_size (font, &text_width, &text_height);
+          if (text_width > stats_width)
+            stats_width = text_width;
+          if (text_height > font_height)
+            font_height = text_height;
+        }
+
+      n_stats += 2;
+    }
+
   /* Ширина текста с названием величины, с её значением и высота строки. */
   mark_width /= PANGO_SCALE;
   label_width /= PANGO_SCALE;
+  stats_width /= PANGO_SCALE;
   font_height /= PANGO_SCALE;
 
   /* Размер места для отображения информации. */
   info_width = 5 * text_spacing + label_width + mark_width;
+  info_width = MAX (info_width, 4 * text_spacing + stats_width);
   info_height = n_labels * (font_height + text_spacing) + 3 * text_spacing;
   if (n_labels > 2)
     info_height += text_spacing;
+  if (n_stats > 0)
+    info_height += n_stats * (font_height + text_spacing) + text_spacing;
 
   /* Проверяем размеры области отображения. */
   if (info_width > (gint)(area_width - 12 * text_spacing))
@@ -1200,9 +2050,9 @@ gtk_cifro_scope_draw_info (GtkWidget *widget,
 
       label_top += text_spacing;
 
-      g_hash_table_iter_init (&channels_iter, priv->channels);
-      while (g_hash_table_iter_next (&channels_iter, NULL, (gpointer) &channel))
+      for (i = 0; i < priv->channels->len; i++)
         {
+          channel = &g_array_index (priv->channels, GtkCifroScopeChannel, i);
           if ((channel->value_scale == 1.0) && (channel->name == NULL))
             continue;
 
@@ -1228,19 +2078,54 @@ gtk_cifro_scope_draw_info (GtkWidget *widget,
           label_top += font_height + text_spacing;
         }
     }
-}
-
-/* Рисование координатных линий в области осциллограмм. */
-static void
-gtk_cifro_scope_draw_axis (GtkWidget            *widget,
-                           cairo_sdline_surface *surface)
-{
-  GtkCifroArea *carea = GTK_CIFRO_AREA (widget);
-  GtkCifroScope *cscope = GTK_CIFRO_SCOPE (widget);
-  GtkCifroScopePrivate *priv = cscope->priv;
+  else
+    {
+      label_top += font_height + text_spacing;
+    }
 
-  gdouble scale_x;
-  gdouble scale_y;
+  /* Статистика каналов. */
+  if (n_stats > 0)
+    {
+      cairo_sdline_set_cairo_color (cairo, priv->axis_color);
+      cairo_move_to (cairo, x1 + 4.5, label_top + 0.5);
+      cairo_line_to (cairo, x1 + info_width - 7.5, label_top + 0.5);
+      cairo_stroke (cairo);
+
+      label_top += text_spacing;
+
+      for (i = 0; i < priv->channels->len; i++)
+        {
+          channel = &g_array_index (priv->channels, GtkCifroScopeChannel, i);
+          if (!channel->show || !gtk_cifro_scope_channel_stats (carea, channel, priv->stats_visible, &stats))
+            continue;
+
+          cairo_sdline_set_cairo_color (cairo, channel->color);
+
+          for (j = 0; j < 2; j++)
+            {
+              gtk_cifro_scope_format_stats (channel->name != NULL ? channel->name : priv->y_axis_name,
+                                            &stats, j, text_str, sizeof(text_str));
+              pango_layout_set_text (font, text_str, -1);
+              cairo_move_to (cairo, x1 + 2 * text_spacing, label_top);
+              pango_cairo_show_layout (cairo, font);
+
+              label_top += font_height + text_spacing;
+            }
+        }
+    }
+}
+
+/* Рисование координатных линий в области осциллограмм. */
+static void
+gtk_cifro_scope_draw_axis (GtkWidget            *widget,
+                           cairo_sdline_surface *surface)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (widget);
+  GtkCifroScope *cscope = GTK_CIFRO_SCOPE (widget);
+  GtkCifroScopePrivate *priv = cscope->priv;
+
+  gdouble scale_x;
+  gdouble scale_y;
 
   gdouble from_x;
   gdouble to_x;
@@ -1294,16 +2179,34 @@ gtk_cifro_scope_draw_axis (GtkWidget            *widget,
   cairo_surface_mark_dirty (surface->cairo_surface);
 }
 
-/* Функция рисования осциллограмм линиями. */
-static void
+/* Функция рисует отрезок осциллограммы. Координата X задаёт столбец точек поверхности. */
+static inline void
+gtk_cifro_scope_draw_segment (cairo_sdline_surface *surface,
+                              GtkCifroScopeChannel *channel,
+                              gdouble               line_width,
+                              gdouble               x1,
+                              gdouble               y1,
+                              gdouble               x2,
+                              gdouble               y2)
+{
+  if (line_width > 1.0)
+    cairo_sdline_thick (surface, x1 + 0.5, y1, x2 + 0.5, y2, line_width, channel->color);
+  else if (channel->antialias)
+    cairo_sdline_aa (surface, x1 + 0.5, y1, x2 + 0.5, y2, channel->color);
+  else
+    cairo_sdline (surface, x1, y1, x2, y2, channel->color);
+}
+
+/* Функция рисования осциллограмм линиями. Если column_values больше нуля и в столбец
+   точек попадает больше column_values значений, минимум и максимум значений столбца
+   берутся из сводных данных. Возвращает число отображённых значений. */
+static guint64
 gtk_cifro_scope_draw_lined_data (GtkWidget            *widget,
                                  cairo_sdline_surface *surface,
-                                 gpointer              channel_id)
+                                 GtkCifroScopeChannel *channel,
+                                 gint                  column_values)
 {
   GtkCifroArea *carea = GTK_CIFRO_AREA (widget);
-  GtkCifroScope *cscope = GTK_CIFRO_SCOPE (widget);
-  GtkCifroScopePrivate *priv = cscope->priv;
-  GtkCifroScopeChannel *channel = g_hash_table_lookup (priv->channels, channel_id);
 
   guint visible_width;
   guint visible_height;
@@ -1322,10 +2225,12 @@ gtk_cifro_scope_draw_lined_data (GtkWidget            *widget,
   gdouble times_step;
   gdouble values_scale;
   gdouble values_shift;
-  guint32 values_color;
+  gdouble line_width;
 
 #define VALUES_DATA(i) ((values_data[i] * values_scale) + values_shift)
 
+  cifro_scope_data_block range;
+
   guint i;
   gint j;
   gint i_range_begin, i_range_end;
@@ -1333,22 +2238,30 @@ gtk_cifro_scope_draw_lined_data (GtkWidget            *widget,
   gdouble y_start, y_end;
   gdouble x1, x2, y1, y2;
   gboolean draw = FALSE;
+  gint i_first = -1;
+  gint i_last = -1;
 
   /* Проверяем существование канала. */
   if ((channel == NULL) || (channel->num <= 0))
-    return;
+    return 0;
 
   gtk_cifro_area_get_visible_size (carea, &visible_width, &visible_height);
   gtk_cifro_area_get_scale (carea, &scale_x, &scale_y);
   gtk_cifro_area_get_view (carea, &from_x, &to_x, &from_y, &to_y);
 
+  /* Масштаб в точках поверхности видимой области. */
+  scale_x /= gtk_cifro_area_get_visible_scale_factor (carea);
+  scale_y /= gtk_cifro_area_get_visible_scale_factor (carea);
+
+  /* Толщина линий задана в точках виджета. */
+  line_width = channel->line_width * gtk_cifro_area_get_visible_scale_factor (carea);
+
   values_data = channel->data;
   values_num = channel->num;
   times_shift = channel->time_shift;
   times_step = channel->time_step;
   values_scale = channel->value_scale;
   values_shift = channel->value_shift;
-  values_color = channel->color;
 
   x_range_begin = from_x - scale_x;
   x_range_end = from_x;
@@ -1381,6 +2294,10 @@ gtk_cifro_scope_draw_lined_data (GtkWidget            *widget,
       if (i_range_end >= values_num)
         i_range_end = values_num - 1;
 
+      if (i_first < 0)
+        i_first = i_range_begin;
+      i_last = i_range_end;
+
       if ((i_range_end == i_range_begin) && (i != visible_width))
         continue;
 
@@ -1444,29 +2361,45 @@ gtk_cifro_scope_draw_lined_data (GtkWidget            *widget,
               y2 = (to_y - VALUES_DATA (i_range_begin + 1)) / scale_y;
               y1 = CLAMP (y1, G_MININT32, G_MAXINT32);
               y2 = CLAMP (y2, G_MININT32, G_MAXINT32);
-              cairo_sdline (surface, x2 - 1, y1, x2, y2, values_color);
+              gtk_cifro_scope_draw_segment (surface, channel, line_width, x2 - 1, y1, x2, y2);
               draw = TRUE;
             }
 
-          for (j = i_range_begin + 1; j <= i_range_end; j++)
+          /* При сниженном качестве минимум и максимум берутся из сводных данных:
+             время просмотра столбца не зависит от числа значений, а выбросы не теряются. */
+          if ((column_values > 0) && ((i_range_end - i_range_begin) > column_values))
             {
-              if (isnan (values_data[j]))
-                continue;
-              y_start = VALUES_DATA (j);
-              y_end = y_start;
-              draw = TRUE;
-              break;
+              cifro_scope_data_summary_range (gtk_cifro_scope_get_summary (channel), values_data,
+                                              i_range_begin + 1, i_range_end + 1, &range);
+              if (range.n_nan < (i_range_end - i_range_begin))
+                {
+                  y_start = MIN (range.min * values_scale, range.max * values_scale) + values_shift;
+                  y_end = MAX (range.min * values_scale, range.max * values_scale) + values_shift;
+                  draw = TRUE;
+                }
             }
-
-          for (; j <= i_range_end; j++)
+          else
             {
-              if (isnan (values_data[j]))
-                continue;
-              if (VALUES_DATA (j) < y_start)
-                y_start = VALUES_DATA (j);
-              if (VALUES_DATA (j) > y_end)
-                y_end = VALUES_DATA (j);
-              draw = TRUE;
+              for (j = i_range_begin + 1; j <= i_range_end; j++)
+                {
+                  if (isnan (values_data[j]))
+                    continue;
+                  y_start = VALUES_DATA (j);
+                  y_end = y_start;
+                  draw = TRUE;
+                  break;
+                }
+
+              for (; j <= i_range_end; j++)
+                {
+                  if (isnan (values_data[j]))
+                    continue;
+                  if (VALUES_DATA (j) < y_start)
+                    y_start = VALUES_DATA (j);
+                  if (VALUES_DATA (j) > y_end)
+                    y_end = VALUES_DATA (j);
+                  draw = TRUE;
+                }
             }
 
           x1 = i;
@@ -1477,7 +2410,7 @@ gtk_cifro_scope_draw_lined_data (GtkWidget            *widget,
         }
 
       if (draw)
-        cairo_sdline (surface, x1, y1, x2, y2, values_color);
+        gtk_cifro_scope_draw_segment (surface, channel, line_width, x1, y1, x2, y2);
 
       if ((i_range_end - i_range_begin) == 1)
         {
@@ -1492,95 +2425,69 @@ gtk_cifro_scope_draw_lined_data (GtkWidget            *widget,
     }
 
   cairo_surface_mark_dirty (surface->cairo_surface);
+
+  return (i_first < 0) ? 0 : i_last - i_first + 1;
 }
 
-/* Функция рисования осциллограмм точками. */
+/* Функция подготавливает карту занятости для столбца из size точек. */
 static void
-gtk_cifro_scope_draw_dotted_data (GtkWidget            *widget,
-                                  cairo_sdline_surface *surface,
-                                  gpointer              channel_id,
-                                  guint                 size)
+gtk_cifro_scope_column_init (GtkCifroScopeColumn *column,
+                             gint                 size)
 {
-  GtkCifroArea *carea = GTK_CIFRO_AREA (widget);
-  GtkCifroScope *cscope = GTK_CIFRO_SCOPE (widget);
-  GtkCifroScopePrivate *priv = cscope->priv;
-  GtkCifroScopeChannel *channel = g_hash_table_lookup (priv->channels, GINT_TO_POINTER( channel_id ));
-
-  gdouble from_x;
-  gdouble to_x;
-  gdouble from_y;
-  gdouble to_y;
-
-  gdouble scale_x;
-  gdouble scale_y;
-
-  gfloat *values_data;
-  gint values_num;
-  gdouble times_shift;
-  gdouble times_step;
-  gdouble values_scale;
-  gdouble values_shift;
-  guint32 values_color;
-
-#define VALUES_TIME(i) ((i * times_step) + times_shift)
-#define VALUES_DATA(i) ((values_data[i] * values_scale) + values_shift)
-
-  gint i;
-  gint i_range_begin, i_range_end;
-  gdouble x, y;
-
-  /* Проверяем существование канала. */
-  if ((channel == NULL) || (channel->num <= 0))
-    return;
-
-  gtk_cifro_area_get_scale (carea, &scale_x, &scale_y);
-  gtk_cifro_area_get_view (carea, &from_x, &to_x, &from_y, &to_y);
-
-  values_data = channel->data;
-  values_num = channel->num;
-  times_shift = channel->time_shift;
-  times_step = channel->time_step;
-  values_scale = channel->value_scale;
-  values_shift = channel->value_shift;
-  values_color = channel->color;
-
-  i_range_begin = (from_x - times_shift) / times_step;
-  i_range_end = (to_x - times_shift) / times_step;
+  column->bits = g_new0 (guint32, (size / 32) + 1);
+  column->size = size;
+  column->x = G_MININT;
+  column->min = G_MAXINT;
+  column->max = G_MININT;
+}
 
-  i_range_begin = CLAMP (i_range_begin, 0, values_num);
-  i_range_end = CLAMP (i_range_end, 0, values_num);
+/* Функция отмечает точку (x, y) занятой. Значения должны перебираться в порядке
+   возрастания X, при переходе к новому столбцу карта очищается. Возвращает FALSE,
+   если точка уже была занята или находится за пределами столбца. */
+static gboolean
+gtk_cifro_scope_column_mark (GtkCifroScopeColumn *column,
+                             gint                 x,
+                             gint                 y)
+{
+  guint32 mask;
 
-  if (i_range_begin > i_range_end)
-    return;
+  if ((y < 0) || (y >= column->size))
+    return FALSE;
 
-  for (i = i_range_begin; i <= i_range_end; i++)
+  if (x != column->x)
     {
-      if (isnan (values_data[i]))
-        continue;
-      x = VALUES_TIME (i);
-      x = (x - from_x) / scale_x;
-      y = VALUES_DATA (i);
-      y = (to_y - y) / scale_y;
-      if (size == 0)
-        cairo_sdline_dot (surface, x, y, values_color);
-      else
-        cairo_sdline_bar (surface, x - size, y - size, x + size, y + size, values_color);
+      if (column->min <= column->max)
+        {
+          memset (column->bits + (column->min / 32), 0,
+                  ((column->max / 32) - (column->min / 32) + 1) * sizeof (guint32));
+        }
+      column->x = x;
+      column->min = G_MAXINT;
+      column->max = G_MININT;
     }
 
-  cairo_surface_mark_dirty (surface->cairo_surface);
+  mask = 1U << (y % 32);
+  if (column->bits[y / 32] & mask)
+    return FALSE;
+
+  column->bits[y / 32] |= mask;
+  column->min = MIN (column->min, y);
+  column->max = MAX (column->max, y);
+
+  return TRUE;
 }
 
-/* Функция рисования осциллограмм перекрестиями. */
-static void
-gtk_cifro_scope_draw_crossed_data (GtkWidget            *widget,
-                                   cairo_sdline_surface *surface,
-                                   gpointer              channel_id,
-                                   guint                 size)
+/* Функция рисования осциллограмм маркерами. Если column_values больше нуля и в столбец
+   точек попадает больше column_values значений, для столбца рисуются маркеры минимального
+   и максимального значений из сводных данных. Возвращает число отображённых значений. */
+static guint64
+gtk_cifro_scope_draw_marked_data (GtkWidget            *widget,
+                                  cairo_sdline_surface *surface,
+                                  GtkCifroScopeChannel *channel,
+                                  cairo_sdline_marker  *marker,
+                                  gint                  column_values)
 {
   GtkCifroArea *carea = GTK_CIFRO_AREA (widget);
-  GtkCifroScope *cscope = GTK_CIFRO_SCOPE (widget);
-  GtkCifroScopePrivate *priv = cscope->priv;
-  GtkCifroScopeChannel *channel = g_hash_table_lookup (priv->channels, GINT_TO_POINTER( channel_id ));
 
   gdouble from_x;
   gdouble to_x;
@@ -1601,17 +2508,35 @@ gtk_cifro_scope_draw_crossed_data (GtkWidget            *widget,
 #define VALUES_TIME(i) ((i * times_step) + times_shift)
 #define VALUES_DATA(i) ((values_data[i] * values_scale) + values_shift)
 
-  gint i;
+  GtkCifroScopeColumn column;
+  guint visible_width;
+  guint visible_height;
+
+  cifro_scope_data_summary *summary = NULL;
+  cifro_scope_data_block range;
+  gint64 column_begin, column_end;
+
+  gint32 points[2 * 256];
+  guint n_points = 0;
+  gint size;
+
+  gint i, k, n_items;
   gint i_range_begin, i_range_end;
   gdouble x, y;
+  gint px, py;
 
   /* Проверяем существование канала. */
   if ((channel == NULL) || (channel->num <= 0))
-    return;
+    return 0;
 
+  gtk_cifro_area_get_visible_size (carea, &visible_width, &visible_height);
   gtk_cifro_area_get_scale (carea, &scale_x, &scale_y);
   gtk_cifro_area_get_view (carea, &from_x, &to_x, &from_y, &to_y);
 
+  /* Масштаб в точках поверхности видимой области. */
+  scale_x /= gtk_cifro_area_get_visible_scale_factor (carea);
+  scale_y /= gtk_cifro_area_get_visible_scale_factor (carea);
+
   values_data = channel->data;
   values_num = channel->num;
   times_shift = channel->time_shift;
@@ -1619,29 +2544,98 @@ gtk_cifro_scope_draw_crossed_data (GtkWidget            *widget,
   values_scale = channel->value_scale;
   values_shift = channel->value_shift;
   values_color = channel->color;
+  size = marker->radius;
 
   i_range_begin = (from_x - times_shift) / times_step;
   i_range_end = (to_x - times_shift) / times_step;
 
-  i_range_begin = CLAMP (i_range_begin, 0, values_num);
-  i_range_end = CLAMP (i_range_end, 0, values_num);
+  i_range_begin = CLAMP (i_range_begin, 0, values_num - 1);
+  i_range_end = CLAMP (i_range_end, 0, values_num - 1);
 
   if (i_range_begin > i_range_end)
-    return;
+    return 0;
+
+  /* Маркеры, которые попадают в одну точку, рисуются один раз. Значения перебираются
+     по возрастанию X, поэтому достаточно карты занятости текущего столбца с запасом
+     на размер маркера сверху и снизу. */
+  gtk_cifro_scope_column_init (&column, visible_height + 2 * size);
 
-  for (i = i_range_begin; i <= i_range_end; i++)
+  /* При сниженном качестве плотные данные отображаются по столбцам точек: на каждый
+     столбец приходится два элемента - минимум и максимум попавших в него значений.
+     Время просмотра столбца не зависит от числа значений, а выбросы не теряются. */
+  if ((column_values > 0) && ((scale_x / times_step) > column_values))
+    summary = gtk_cifro_scope_get_summary (channel);
+
+  if (summary != NULL)
+    n_items = 2 * visible_width;
+  else
+    n_items = i_range_end - i_range_begin + 1;
+
+  for (k = 0; k < n_items; k++)
     {
-      if (isnan (values_data[i]))
-        continue;
-      x = VALUES_TIME (i);
-      x = (x - from_x) / scale_x;
-      y = VALUES_DATA (i);
+      if (summary == NULL)
+        {
+          i = i_range_begin + k;
+          if (isnan (values_data[i]))
+            continue;
+          x = VALUES_TIME (i);
+          x = (x - from_x) / scale_x;
+          y = VALUES_DATA (i);
+        }
+      else
+        {
+          /* Значения с индексами [column_begin, column_end) попадают в столбец k / 2. */
+          if ((k % 2) == 0)
+            {
+              column_begin = ceil ((from_x + (k / 2) * scale_x - times_shift) / times_step);
+              column_end = ceil ((from_x + (k / 2 + 1) * scale_x - times_shift) / times_step);
+              column_begin = MAX (column_begin, i_range_begin);
+              column_end = MIN (column_end, i_range_end + 1);
+
+              range.n_nan = 0;
+              if (column_begin < column_end)
+                cifro_scope_data_summary_range (summary, values_data, column_begin, column_end, &range);
+              else
+                column_end = column_begin;
+            }
+
+          if (range.n_nan == (column_end - column_begin))
+            continue;
+
+          x = k / 2;
+          y = ((k % 2) == 0) ? range.min : range.max;
+          y = (y * values_scale) + values_shift;
+        }
+
       y = (to_y - y) / scale_y;
-      cairo_sdline_h (surface, x - size, x + size, y, values_color);
-      cairo_sdline_v (surface, x, y - size, y + size, values_color);
+
+      /* Маркеры за пределами области отображения не рисуются. */
+      if ((y <= -1.0 - size) || (y >= visible_height + size))
+        continue;
+
+      /* Координаты округляются вниз, чтобы отрицательные значения попадали в свои точки. */
+      px = floor (x);
+      py = floor (y);
+      if (!gtk_cifro_scope_column_mark (&column, px, py + size))
+        continue;
+
+      /* Маркеры рисуются пачками. */
+      points[2 * n_points] = px;
+      points[2 * n_points + 1] = py;
+      if (++n_points == G_N_ELEMENTS (points) / 2)
+        {
+          cairo_sdline_marker_draw_array (surface, marker, points, n_points, values_color);
+          n_points = 0;
+        }
     }
 
+  cairo_sdline_marker_draw_array (surface, marker, points, n_points, values_color);
+
+  g_free (column.bits);
+
   cairo_surface_mark_dirty (surface->cairo_surface);
+
+  return i_range_end - i_range_begin + 1;
 }
 
 /* Функция рисования оцифровки осей и информации. */
@@ -1659,6 +2653,138 @@ gtk_cifro_scope_area_draw (GtkWidget *widget,
     gtk_cifro_scope_draw_info (widget, cairo);
 }
 
+/* Функция рисования осциллограммы канала. Команды рисования записываются
+   и повторно используются, пока не изменятся видимая область, параметры
+   отображения или данные канала. */
+static void
+gtk_cifro_scope_draw_channel (GtkWidget            *widget,
+                              cairo_sdline_surface *surface,
+                              GtkCifroScopeChannel *channel)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (widget);
+  GtkCifroScopePrivate *priv = GTK_CIFRO_SCOPE (widget)->priv;
+
+  cairo_sdline_commands *recording;
+  cairo_sdline_blend blend;
+  GtkCifroScopeDrawKey key;
+  cairo_sdline_marker *marker;
+  gboolean translucent;
+  gint column_values;
+  guint64 samples = 0;
+
+  CIFRO_AREA_TRACE_BEGIN (draw_channel);
+
+  memset (&key, 0, sizeof (key));
+  gtk_cifro_area_get_view (carea, &key.from_x, &key.to_x, &key.from_y, &key.to_y);
+  gtk_cifro_area_get_visible_size (carea, &key.width, &key.height);
+  key.draw_type = channel->draw_type;
+  key.color = channel->color;
+  key.antialias = channel->antialias;
+  key.line_width = channel->line_width;
+  key.time_shift = channel->time_shift;
+  key.time_step = channel->time_step;
+  key.value_shift = channel->value_shift;
+  key.value_scale = channel->value_scale;
+  key.scale_factor = gtk_cifro_area_get_visible_scale_factor (carea);
+  key.generation = channel->generation;
+  key.quality = gtk_cifro_area_get_quality (carea);
+
+  /* При сниженном качестве плотные данные отображаются по минимуму и максимуму
+     значений в столбце точек из сводных данных, а в режимах линий с маркерами
+     рисуются только линии. В черновом качестве все осциллограммы рисуются линиями. */
+  if (key.quality == GTK_CIFRO_AREA_QUALITY_DRAFT)
+    column_values = DRAFT_COLUMN_VALUES;
+  else if (key.quality == GTK_CIFRO_AREA_QUALITY_FAST)
+    column_values = FAST_COLUMN_VALUES;
+  else
+    column_values = 0;
+
+  /* Полупрозрачная осциллограмма рисуется в маску с выбором максимума, а затем
+     накладывается на поверхность один раз. Иначе точки, через которые линия
+     проходит несколько раз, смешиваются повторно и становятся ярче остальных. */
+  translucent = (channel->color >> 24) != 0xFF;
+
+  /* Записываем команды рисования заново. */
+  if ((channel->commands == NULL) || (memcmp (&key, &channel->commands_key, sizeof (key)) != 0))
+    {
+      if (channel->commands == NULL)
+        channel->commands = cairo_sdline_commands_new ();
+      else
+        cairo_sdline_commands_clear (channel->commands);
+
+      recording = surface->recording;
+      blend = surface->blend;
+      cairo_sdline_surface_set_recording (surface, channel->commands);
+      if (translucent)
+        cairo_sdline_set_blend (surface, CAIRO_SDLINE_BLEND_MAX);
+
+      switch (channel->draw_type)
+        {
+        case GTK_CIFRO_SCOPE_DOTTED:
+        case GTK_CIFRO_SCOPE_DOTTED2:
+        case GTK_CIFRO_SCOPE_CROSSED:
+          if (channel->draw_type == GTK_CIFRO_SCOPE_DOTTED)
+            marker = priv->dot_marker;
+          else if (channel->draw_type == GTK_CIFRO_SCOPE_DOTTED2)
+            marker = priv->dot2_marker;
+          else
+            marker = priv->cross_marker;
+
+          if (key.quality == GTK_CIFRO_AREA_QUALITY_DRAFT)
+            samples = gtk_cifro_scope_draw_lined_data (widget, surface, channel, column_values);
+          else
+            samples = gtk_cifro_scope_draw_marked_data (widget, surface, channel, marker, column_values);
+          break;
+
+        case GTK_CIFRO_SCOPE_DOTTED_LINE:
+        case GTK_CIFRO_SCOPE_CROSSED_LINE:
+          if (channel->draw_type == GTK_CIFRO_SCOPE_DOTTED_LINE)
+            marker = priv->dot2_marker;
+          else
+            marker = priv->cross_marker;
+
+          if (key.quality == GTK_CIFRO_AREA_QUALITY_FULL)
+            samples = gtk_cifro_scope_draw_marked_data (widget, surface, channel, marker, column_values);
+          samples += gtk_cifro_scope_draw_lined_data (widget, surface, channel, column_values);
+          break;
+
+        default:
+          samples = gtk_cifro_scope_draw_lined_data (widget, surface, channel, column_values);
+        }
+
+      cairo_sdline_set_blend (surface, blend);
+      cairo_sdline_surface_set_recording (surface, recording);
+      channel->commands_key = key;
+    }
+
+  /* При многопоточном рисовании команды добавляются в общий список. Значения
+     просматриваются только при записи команд. */
+  if (translucent)
+    {
+      /* Маска у каждого канала своя, так как при многопоточном рисовании
+         она накладывается при воспроизведении общего списка команд. */
+      if ((channel->mask == NULL) ||
+          (channel->mask->width != surface->width) || (channel->mask->height != surface->height))
+        {
+          cairo_sdline_surface_destroy (channel->mask);
+          channel->mask = cairo_sdline_surface_create_with_format (CAIRO_FORMAT_A8, surface->width, surface->height);
+        }
+
+      cairo_sdline_clear (channel->mask);
+      channel->mask->n_pixels = 0;
+      cairo_sdline_commands_replay (channel->mask, channel->commands, priv->render_threads);
+      cairo_sdline_mask (surface, channel->mask, 0, 0, channel->color);
+      gtk_cifro_area_add_render_stats (carea, 0, 0, channel->mask->n_pixels);
+    }
+  else
+    {
+      cairo_sdline_commands_replay (surface, channel->commands, 1);
+    }
+  gtk_cifro_area_add_render_stats (carea, samples, cairo_sdline_commands_get_n_primitives (channel->commands), 0);
+
+  CIFRO_AREA_TRACE_END (draw_channel, channel->id);
+}
+
 /* Функция рисования видимой области (осциллограмм). */
 static void
 gtk_cifro_scope_visible_draw (GtkWidget *widget,
@@ -1670,9 +2796,8 @@ gtk_cifro_scope_visible_draw (GtkWidget *widget,
 
   cairo_sdline_surface *surface;
 
-  GHashTableIter channels_iter;
   GtkCifroScopeChannel *channel;
-  gpointer channel_id;
+  guint i;
 
   guint width, height;
 
@@ -1681,45 +2806,32 @@ gtk_cifro_scope_visible_draw (GtkWidget *widget,
 
   surface = cairo_sdline_surface_create_for (cairo_get_target (cairo));
 
+  /* Изображение можно показывать во время анимации, пока не изменятся данные каналов. */
+  gtk_cifro_area_set_frame_reusable (carea, TRUE);
+
+  /* При многопоточном рисовании команды сначала записываются, а затем
+     воспроизводятся по полосам поверхности в нескольких потоках. */
+  if (priv->render_threads != 1)
+    cairo_sdline_surface_set_recording (surface, priv->commands);
+
+  /* Размеры маркеров следуют за разрешением поверхности видимой области. */
+  gtk_cifro_scope_update_markers (priv, gtk_cifro_area_get_visible_scale_factor (carea));
+
   /* Рисуем оси. */
   gtk_cifro_scope_draw_axis (widget, surface);
 
-  /* Рисуем осциллограммы. */
-  g_hash_table_iter_init (&channels_iter, priv->channels);
-  while (g_hash_table_iter_next (&channels_iter, &channel_id, (gpointer) &channel))
+  /* Рисуем осциллограммы, полупрозрачные каналы накладываются на уже нарисованные. */
+  cairo_sdline_set_blend (surface, CAIRO_SDLINE_BLEND_OVER);
+  for (i = 0; i < priv->draw_order->len; i++)
     {
+      channel = &g_array_index (priv->channels, GtkCifroScopeChannel,
+                                g_array_index (priv->draw_order, guint, i));
       if (channel->show)
-        {
-          switch (channel->draw_type)
-            {
-            case GTK_CIFRO_SCOPE_DOTTED:
-              gtk_cifro_scope_draw_dotted_data (widget, surface, channel_id, 0);
-              break;
-
-            case GTK_CIFRO_SCOPE_DOTTED2:
-              gtk_cifro_scope_draw_dotted_data (widget, surface, channel_id, 1);
-              break;
-
-            case GTK_CIFRO_SCOPE_DOTTED_LINE:
-              gtk_cifro_scope_draw_dotted_data (widget, surface, channel_id, 1);
-              gtk_cifro_scope_draw_lined_data (widget, surface, channel_id);
-              break;
-
-            case GTK_CIFRO_SCOPE_CROSSED:
-              gtk_cifro_scope_draw_crossed_data (widget, surface, channel_id, 3);
-              break;
-
-            case GTK_CIFRO_SCOPE_CROSSED_LINE:
-              gtk_cifro_scope_draw_crossed_data (widget, surface, channel_id, 3);
-              gtk_cifro_scope_draw_lined_data (widget, surface, channel_id);
-              break;
-
-            default:
-              gtk_cifro_scope_draw_lined_data (widget, surface, channel_id);
-            }
-        }
+        gtk_cifro_scope_draw_channel (widget, surface, channel);
     }
 
+  cairo_sdline_set_blend (surface, CAIRO_SDLINE_BLEND_COPY);
+
   /* Рисуем окантовку. */
   gtk_cifro_area_get_visible_size (carea, &width, &height);
   cairo_sdline_h (surface, 0, width - 1, 0, priv->border_color);
@@ -1727,9 +2839,35 @@ gtk_cifro_scope_visible_draw (GtkWidget *widget,
   cairo_sdline_h (surface, 0, width - 1, height - 1, priv->border_color);
   cairo_sdline_v (surface, width - 1, 0, height - 1, priv->border_color);
 
+  if (priv->render_threads != 1)
+    {
+      cairo_sdline_surface_set_recording (surface, NULL);
+      cairo_sdline_commands_replay (surface, priv->commands, priv->render_threads);
+      cairo_sdline_commands_clear (priv->commands);
+    }
+
+  gtk_cifro_area_add_render_stats (carea, 0, 0, surface->n_pixels);
+
   cairo_sdline_surface_destroy (surface);
 }
 
+/* Функция обработки сигнала изменения параметров отображения. При непрерывном
+   масштабировании после изменения видимой области по оси времени пересчитываются
+   границы оси значений, до начала формирования следующего кадра. */
+static void
+gtk_cifro_scope_view_changed (GtkWidget *widget)
+{
+  GtkCifroScopePrivate *priv = GTK_CIFRO_SCOPE (widget)->priv;
+  gdouble from_x, to_x;
+
+  if (!priv->autoscale)
+    return;
+
+  gtk_cifro_area_get_view (GTK_CIFRO_AREA (widget), &from_x, &to_x, NULL, NULL);
+  if ((from_x != priv->autoscale_from_x) || (to_x != priv->autoscale_to_x))
+    gtk_cifro_scope_autoscale_apply (GTK_CIFRO_SCOPE (widget));
+}
+
 /* Функция обработки сигнала изменения параметров дисплея. */
 static gboolean
 gtk_cifro_scope_configure (GtkWidget            *widget,
@@ -1947,6 +3085,106 @@ gtk_cifro_scope_set_info_show (GtkCifroScope *cscope,
   gtk_widget_queue_draw (GTK_WIDGET (cscope));
 }
 
+/**
+ * gtk_cifro_scope_set_info_stats:
+ * @cscope: указатель на #GtkCifroScope
+ * @show: признак отображения статистики каналов
+ * @visible_only: %TRUE - статистика по видимой области, %FALSE - по всем данным канала
+ *
+ * Функция включает (@show = %TRUE) или выключает (@show = %FALSE) отображение
+ * статистики видимых каналов в блоке с информацией о значениях под курсором.
+ * Подробнее о статистике см. gtk_cifro_scope_get_channel_stats().
+ *
+ */
+void
+gtk_cifro_scope_set_info_stats (GtkCifroScope *cscope,
+                                gboolean       show,
+                                gboolean       visible_only)
+{
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  cscope->priv->show_stats = show;
+  cscope->priv->stats_visible = visible_only;
+
+  gtk_widget_queue_draw (GTK_WIDGET (cscope));
+}
+
+/**
+ * gtk_cifro_scope_set_autoscale:
+ * @cscope: указатель на #GtkCifroScope
+ * @continuous: признак непрерывного масштабирования
+ * @margin: запас по оси значений в долях от размаха данных
+ *
+ * Функция задаёт параметры автоматического масштабирования оси значений. При
+ * непрерывном масштабировании (@continuous = %TRUE) границы оси значений
+ * пересчитываются сразу после каждого изменения данных каналов и видимой области
+ * по оси времени.
+ *
+ * Подробнее о масштабировании см. gtk_cifro_scope_autoscale().
+ *
+ */
+void
+gtk_cifro_scope_set_autoscale (GtkCifroScope *cscope,
+                               gboolean       continuous,
+                               gdouble        margin)
+{
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+  g_return_if_fail (margin >= 0.0);
+
+  cscope->priv->autoscale = continuous;
+  cscope->priv->autoscale_margin = margin;
+
+  if (continuous)
+    gtk_cifro_scope_autoscale_apply (cscope);
+}
+
+/**
+ * gtk_cifro_scope_autoscale:
+ * @cscope: указатель на #GtkCifroScope
+ *
+ * Функция устанавливает границы оси значений по минимальному и максимальному
+ * значениям видимых каналов в видимой области по оси времени с учётом масштаба
+ * и смещения значений каналов. Границы оси времени не изменяются.
+ *
+ * Минимальное и максимальное значения определяются по иерархии сводных данных
+ * канала за время O(log N). Иерархия строится при первом обращении и затем обновляется
+ * вместе с данными канала. Границы ограничиваются диапазоном, заданным функцией
+ * gtk_cifro_scope_set_limits(), а масштаб - диапазоном, заданным функцией
+ * gtk_cifro_scope_set_scale_limits().
+ *
+ */
+void
+gtk_cifro_scope_autoscale (GtkCifroScope *cscope)
+{
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  gtk_cifro_scope_autoscale_apply (cscope);
+}
+
+/**
+ * gtk_cifro_scope_set_render_threads:
+ * @cscope: указатель на #GtkCifroScope
+ * @n_threads: число потоков рисования
+ *
+ * Функция задаёт число потоков для рисования осциллограмм. При использовании
+ * нескольких потоков команды рисования сначала записываются, а затем область
+ * отображения делится на горизонтальные полосы, каждая из которых рисуется
+ * в отдельном потоке. Изображение не зависит от числа потоков. Если @n_threads
+ * равно 0, используются все процессоры системы. По умолчанию осциллограммы
+ * рисуются в одном потоке.
+ *
+ */
+void
+gtk_cifro_scope_set_render_threads (GtkCifroScope *cscope,
+                                    guint          n_threads)
+{
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  cscope->priv->render_threads = n_threads;
+
+  gtk_widget_queue_draw (GTK_WIDGET (cscope));
+}
+
 /**
  * gtk_cifro_scope_set_axis_name:
  * @cscope: указатель на #GtkCifroScope
@@ -1989,28 +3227,31 @@ guint
 gtk_cifro_scope_add_channel (GtkCifroScope *cscope)
 {
   GtkCifroScopePrivate *priv;
-  GtkCifroScopeChannel* channel;
+  GtkCifroScopeChannel channel = {0};
   guint channel_id = 0;
 
   g_return_val_if_fail (GTK_IS_CIFRO_SCOPE (cscope), 0);
 
   priv = cscope->priv;
 
-  /* Параметры канала по умолчанию. */
-  channel = g_new0 (GtkCifroScopeChannel, 1);
-  channel->time_step = 1.0;
-  channel->value_scale = 1.0;
-  channel->draw_type = GTK_CIFRO_SCOPE_LINED;
-  channel->color = cairo_sdline_color (g_random_double_range (0.5, 1.0),
-                                       g_random_double_range (0.5, 1.0),
-                                       g_random_double_range (0.5, 1.0),
-                                       1.0);
-
   /* Генерируем новый идентификатор канала. */
-  while ((channel_id == 0) || g_hash_table_contains (priv->channels, GUINT_TO_POINTER (channel_id)))
+  while ((channel_id == 0) || (gtk_cifro_scope_get_channel (priv, channel_id) != NULL))
     channel_id = g_random_int ();
 
-  g_hash_table_insert (priv->channels, GUINT_TO_POINTER (channel_id), channel);
+  /* Параметры канала по умолчанию. */
+  channel.id = channel_id;
+  channel.time_shift = priv->trigger_shift;
+  channel.time_step = 1.0;
+  channel.value_scale = 1.0;
+  channel.line_width = 1.0;
+  channel.draw_type = GTK_CIFRO_SCOPE_LINED;
+  channel.color = cairo_sdline_color (g_random_double_range (0.5, 1.0),
+                                      g_random_double_range (0.5, 1.0),
+                                      g_random_double_range (0.5, 1.0),
+                                      1.0);
+
+  g_array_append_val (priv->channels, channel);
+  gtk_cifro_scope_update_order (priv);
 
   return channel_id;
 }
@@ -2027,9 +3268,23 @@ void
 gtk_cifro_scope_remove_channel (GtkCifroScope *cscope,
                                 guint          channel_id)
 {
+  GtkCifroScopePrivate *priv;
+  guint index;
+
   g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
 
-  g_hash_table_remove (cscope->priv->channels, GUINT_TO_POINTER (channel_id));
+  priv = cscope->priv;
+
+  index = GPOINTER_TO_UINT (g_hash_table_lookup (priv->channels_index, GUINT_TO_POINTER (channel_id)));
+  if (index == 0)
+    return;
+
+  g_array_remove_index (priv->channels, index - 1);
+  gtk_cifro_scope_update_order (priv);
+
+  /* Без источника синхронизации данные не удерживаются. */
+  if (channel_id == priv->trigger_channel)
+    priv->trigger_hold = FALSE;
 
   gtk_widget_queue_draw (GTK_WIDGET (cscope));
 }
@@ -2049,16 +3304,15 @@ gtk_cifro_scope_set_channel_name (GtkCifroScope *cscope,
                                   guint          channel_id,
                                   const gchar   *axis_name)
 {
-  GHashTableIter channels_iter;
   GtkCifroScopeChannel *channel;
-  gpointer cur_channel_id;
+  guint i;
 
   g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
 
-  g_hash_table_iter_init (&channels_iter, cscope->priv->channels);
-  while (g_hash_table_iter_next (&channels_iter, (gpointer) &cur_channel_id, (gpointer) &channel))
+  for (i = 0; i < cscope->priv->channels->len; i++)
     {
-      if ((channel_id == 0) || (GPOINTER_TO_UINT (cur_channel_id) == channel_id))
+      channel = &g_array_index (cscope->priv->channels, GtkCifroScopeChannel, i);
+      if ((channel_id == 0) || (channel->id == channel_id))
         {
           g_free (channel->name);
           channel->name = g_strdup (axis_name);
@@ -2087,19 +3341,21 @@ gtk_cifro_scope_set_channel_time_param (GtkCifroScope *cscope,
                                         gdouble        time_shift,
                                         gdouble        time_step)
 {
-  GHashTableIter channels_iter;
   GtkCifroScopeChannel *channel;
-  gpointer cur_channel_id;
+  guint i;
 
   g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
 
-  g_hash_table_iter_init (&channels_iter, cscope->priv->channels);
-  while (g_hash_table_iter_next (&channels_iter, (gpointer) &cur_channel_id, (gpointer) &channel))
-    if ((channel_id == 0) || (GPOINTER_TO_UINT (cur_channel_id) == channel_id))
-      {
-        channel->time_shift = time_shift;
-        channel->time_step = time_step;
-      }
+  for (i = 0; i < cscope->priv->channels->len; i++)
+    {
+      channel = &g_array_index (cscope->priv->channels, GtkCifroScopeChannel, i);
+      if ((channel_id == 0) || (channel->id == channel_id))
+        {
+          channel->user_time_shift = time_shift;
+          channel->time_shift = time_shift + cscope->priv->trigger_shift;
+          channel->time_step = time_step;
+        }
+    }
 
   gtk_widget_queue_draw (GTK_WIDGET (cscope));
 }
@@ -2123,16 +3379,15 @@ gtk_cifro_scope_set_channel_value_param (GtkCifroScope *cscope,
                                          gdouble        value_shift,
                                          gdouble        value_scale)
 {
-  GHashTableIter channels_iter;
   GtkCifroScopeChannel *channel;
-  gpointer cur_channel_id;
+  guint i;
 
   g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
 
-  g_hash_table_iter_init (&channels_iter, cscope->priv->channels);
-  while (g_hash_table_iter_next (&channels_iter, (gpointer) &cur_channel_id, (gpointer) &channel))
+  for (i = 0; i < cscope->priv->channels->len; i++)
     {
-      if ((channel_id == 0) || (GPOINTER_TO_UINT (cur_channel_id) == channel_id))
+      channel = &g_array_index (cscope->priv->channels, GtkCifroScopeChannel, i);
+      if ((channel_id == 0) || (channel->id == channel_id))
         {
           channel->value_shift = value_shift;
           channel->value_scale = value_scale;
@@ -2157,16 +3412,15 @@ gtk_cifro_scope_set_channel_draw_type (GtkCifroScope         *cscope,
                                        guint                  channel_id,
                                        GtkCifroScopeDrawType  draw_type)
 {
-  GHashTableIter channels_iter;
   GtkCifroScopeChannel *channel;
-  gpointer cur_channel_id;
+  guint i;
 
   g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
 
-  g_hash_table_iter_init (&channels_iter, cscope->priv->channels);
-  while (g_hash_table_iter_next (&channels_iter, (gpointer) &cur_channel_id, (gpointer) &channel))
+  for (i = 0; i < cscope->priv->channels->len; i++)
     {
-      if ((channel_id == 0) || (GPOINTER_TO_UINT (cur_channel_id) == channel_id))
+      channel = &g_array_index (cscope->priv->channels, GtkCifroScopeChannel, i);
+      if ((channel_id == 0) || (channel->id == channel_id))
         channel->draw_type = draw_type;
     }
 
@@ -2192,17 +3446,117 @@ gtk_cifro_scope_set_channel_color (GtkCifroScope *cscope,
                                    gdouble        green,
                                    gdouble        blue)
 {
-  GHashTableIter channels_iter;
   GtkCifroScopeChannel *channel;
-  gpointer cur_channel_id;
+  guint i;
+
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  for (i = 0; i < cscope->priv->channels->len; i++)
+    {
+      channel = &g_array_index (cscope->priv->channels, GtkCifroScopeChannel, i);
+      if ((channel_id == 0) || (channel->id == channel_id))
+        {
+          channel->color = (channel->color & 0xFF000000) |
+                           (cairo_sdline_color (red, green, blue, 1.0) & 0x00FFFFFF);
+        }
+    }
+
+  gtk_widget_queue_draw (GTK_WIDGET (cscope));
+}
+
+/**
+ * gtk_cifro_scope_set_channel_antialias:
+ * @cscope: указатель на #GtkCifroScope
+ * @channel_id: идентификатор канала данных
+ * @antialias: признак сглаживания линий
+ *
+ * Функция включает (@antialias = %TRUE) или выключает (@antialias = %FALSE) сглаживание
+ * линий осциллограммы канала. Если идентификатор канала равен 0 сглаживание
+ * устанавливается для всех каналов.
+ *
+ */
+void
+gtk_cifro_scope_set_channel_antialias (GtkCifroScope *cscope,
+                                       guint          channel_id,
+                                       gboolean       antialias)
+{
+  GtkCifroScopeChannel *channel;
+  guint i;
+
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  for (i = 0; i < cscope->priv->channels->len; i++)
+    {
+      channel = &g_array_index (cscope->priv->channels, GtkCifroScopeChannel, i);
+      if ((channel_id == 0) || (channel->id == channel_id))
+        channel->antialias = antialias;
+    }
+
+  gtk_widget_queue_draw (GTK_WIDGET (cscope));
+}
+
+/**
+ * gtk_cifro_scope_set_channel_line_width:
+ * @cscope: указатель на #GtkCifroScope
+ * @channel_id: идентификатор канала данных
+ * @line_width: толщина линий в точках виджета
+ *
+ * Функция устанавливает толщину линий осциллограммы канала. Линии толщиной больше
+ * одной точки рисуются с закруглёнными концами и соединениями без сглаживания.
+ * Если идентификатор канала равен 0 толщина устанавливается для всех каналов.
+ *
+ */
+void
+gtk_cifro_scope_set_channel_line_width (GtkCifroScope *cscope,
+                                        guint          channel_id,
+                                        gdouble        line_width)
+{
+  GtkCifroScopeChannel *channel;
+  guint i;
 
   g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+  g_return_if_fail (line_width > 0.0);
 
-  g_hash_table_iter_init (&channels_iter, cscope->priv->channels);
-  while (g_hash_table_iter_next (&channels_iter, (gpointer) &cur_channel_id, (gpointer) &channel))
+  for (i = 0; i < cscope->priv->channels->len; i++)
     {
-      if ((channel_id == 0) || (GPOINTER_TO_UINT (cur_channel_id) == channel_id))
-        channel->color = cairo_sdline_color (red, green, blue, 1.0);
+      channel = &g_array_index (cscope->priv->channels, GtkCifroScopeChannel, i);
+      if ((channel_id == 0) || (channel->id == channel_id))
+        channel->line_width = line_width;
+    }
+
+  gtk_widget_queue_draw (GTK_WIDGET (cscope));
+}
+
+/**
+ * gtk_cifro_scope_set_channel_opacity:
+ * @cscope: указатель на #GtkCifroScope
+ * @channel_id: идентификатор канала данных
+ * @opacity: непрозрачность от 0 до 1
+ *
+ * Функция устанавливает непрозрачность отображения данных канала. Полупрозрачные
+ * данные накладываются на оси и данные каналов, нарисованных раньше (см.
+ * gtk_cifro_scope_set_channel_z_order()). Если идентификатор канала равен 0
+ * непрозрачность устанавливается для всех каналов.
+ *
+ */
+void
+gtk_cifro_scope_set_channel_opacity (GtkCifroScope *cscope,
+                                     guint          channel_id,
+                                     gdouble        opacity)
+{
+  GtkCifroScopeChannel *channel;
+  guint i;
+
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  for (i = 0; i < cscope->priv->channels->len; i++)
+    {
+      channel = &g_array_index (cscope->priv->channels, GtkCifroScopeChannel, i);
+      if ((channel_id == 0) || (channel->id == channel_id))
+        {
+          channel->color = (channel->color & 0x00FFFFFF) |
+                           (cairo_sdline_color (0.0, 0.0, 0.0, opacity) & 0xFF000000);
+        }
     }
 
   gtk_widget_queue_draw (GTK_WIDGET (cscope));
@@ -2217,6 +3571,10 @@ gtk_cifro_scope_set_channel_color (GtkCifroScope *cscope,
  *
  * Функция устанавливает данные канала для отображения.
  *
+ * Если включена синхронизация, данные канала - источника синхронизации должны
+ * передаваться первыми в каждом кадре. По ним принимается решение об отображении
+ * данных всех каналов до поступления следующих данных источника.
+ *
  */
 void
 gtk_cifro_scope_set_channel_data (GtkCifroScope *cscope,
@@ -2224,26 +3582,74 @@ gtk_cifro_scope_set_channel_data (GtkCifroScope *cscope,
                                   guint          n_values,
                                   const gfloat  *values)
 {
+  GtkCifroScopePrivate *priv;
   GtkCifroScopeChannel* channel;
 
   g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
 
-  channel = g_hash_table_lookup (cscope->priv->channels, GUINT_TO_POINTER (channel_id));
+  priv = cscope->priv;
+
+  channel = gtk_cifro_scope_get_channel (priv, channel_id);
   if (channel == NULL)
     return;
 
+  /* Решение об отображении данных принимается по данным источника синхронизации
+     и действует до поступления следующих данных от него. */
+  if ((priv->trigger_type != GTK_CIFRO_SCOPE_TRIGGER_NONE) && (channel_id == priv->trigger_channel))
+    priv->trigger_hold = !gtk_cifro_scope_trigger_update (cscope, channel, n_values, values);
+
+  if (priv->trigger_hold)
+    return;
+
+  CIFRO_AREA_TRACE_BEGIN (set_channel_data);
+
+  channel->stats_valid = FALSE;
+  channel->generation += 1;
+  gtk_cifro_area_set_frame_reusable (GTK_CIFRO_AREA (cscope), FALSE);
+
   if (n_values > channel->size)
     {
       channel->data = g_renew (float, channel->data, n_values);
       channel->size = n_values;
     }
 
-  channel->num = n_values;
-  if (n_values > 0)
+  /* Если сводные данные уже построены, они обновляются только для изменившихся
+     блоков значений, чтобы кадры со сниженным качеством и автоматическое
+     масштабирование не строили их заново после каждого обновления данных. */
+  if ((channel->summary != NULL) && (channel->summary->n_values == n_values))
     {
-      memcpy (channel->data, values, n_values * sizeof(gfloat));
-      channel->show = TRUE;
+      gint64 begin, end;
+
+      for (begin = 0; begin < n_values; begin = end)
+        {
+          end = MIN ((gint64) n_values, begin + CIFRO_SCOPE_DATA_SUMMARY_BLOCK);
+          if (memcmp (channel->data + begin, values + begin, (end - begin) * sizeof(gfloat)) == 0)
+            continue;
+
+          memcpy (channel->data + begin, values + begin, (end - begin) * sizeof(gfloat));
+          cifro_scope_data_summary_update (channel->summary, channel->data, begin, end);
+        }
+    }
+  else
+    {
+      if (n_values > 0)
+        memcpy (channel->data, values, n_values * sizeof(gfloat));
+
+      if (channel->summary != NULL)
+        {
+          cifro_scope_data_summary_free (channel->summary);
+          channel->summary = cifro_scope_data_summary_new (channel->data, n_values);
+        }
     }
+
+  channel->num = n_values;
+  if (n_values > 0)
+    channel->show = TRUE;
+
+  if (priv->autoscale)
+    gtk_cifro_scope_autoscale_apply (cscope);
+
+  CIFRO_AREA_TRACE_END (set_channel_data, n_values);
 }
 
 /**
@@ -2261,18 +3667,363 @@ gtk_cifro_scope_set_channel_show (GtkCifroScope *cscope,
                                   guint          channel_id,
                                   gboolean       show)
 {
-  GHashTableIter channels_iter;
   GtkCifroScopeChannel *channel;
-  gpointer cur_channel_id;
+  guint i;
 
   g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
 
-  g_hash_table_iter_init (&channels_iter, cscope->priv->channels);
-  while (g_hash_table_iter_next (&channels_iter, (gpointer) &cur_channel_id, (gpointer) &channel))
+  for (i = 0; i < cscope->priv->channels->len; i++)
     {
-      if ((channel_id == 0) || (GPOINTER_TO_UINT (cur_channel_id) == channel_id))
+      channel = &g_array_index (cscope->priv->channels, GtkCifroScopeChannel, i);
+      if ((channel_id == 0) || (channel->id == channel_id))
         channel->show = show;
     }
 
   gtk_widget_queue_draw (GTK_WIDGET (cscope));
 }
+
+/**
+ * gtk_cifro_scope_set_channel_z_order:
+ * @cscope: указатель на #GtkCifroScope
+ * @channel_id: идентификатор канала данных
+ * @z_order: порядок отрисовки канала
+ *
+ * Функция устанавливает порядок отрисовки канала. Каналы с большим значением @z_order
+ * рисуются поверх каналов с меньшим значением. Каналы с одинаковым значением @z_order
+ * рисуются в порядке их добавления. По умолчанию порядок отрисовки всех каналов равен 0.
+ * Если идентификатор канала равен 0 порядок отрисовки устанавливается для всех каналов.
+ *
+ */
+void
+gtk_cifro_scope_set_channel_z_order (GtkCifroScope *cscope,
+                                     guint          channel_id,
+                                     gint           z_order)
+{
+  GtkCifroScopeChannel *channel;
+  guint i;
+
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  for (i = 0; i < cscope->priv->channels->len; i++)
+    {
+      channel = &g_array_index (cscope->priv->channels, GtkCifroScopeChannel, i);
+      if ((channel_id == 0) || (channel->id == channel_id))
+        channel->z_order = z_order;
+    }
+
+  gtk_cifro_scope_update_order (cscope->priv);
+
+  gtk_widget_queue_draw (GTK_WIDGET (cscope));
+}
+
+/**
+ * gtk_cifro_scope_set_trigger:
+ * @cscope: указатель на #GtkCifroScope
+ * @channel_id: идентификатор канала - источника синхронизации
+ * @type: тип синхронизации
+ * @level: уровень синхронизации
+ * @hysteresis: гистерезис уровня синхронизации
+ *
+ * Функция устанавливает параметры синхронизации осциллографа. Уровень и гистерезис
+ * задаются в единицах оси значений, т.е. с учётом коэффициентов масштабирования и
+ * смещения данных канала.
+ *
+ * Синхронизация выполняется при поступлении новых данных канала - источника. В данных
+ * ищется событие синхронизации и смещение по времени всех каналов изменяется так, чтобы
+ * точка синхронизации оказалась в заданном функцией gtk_cifro_scope_set_trigger_position()
+ * месте видимой области.
+ *
+ * Перед срабатыванием синхронизации сигнал должен отойти от уровня на величину гистерезиса.
+ * Для синхронизации по длительности импульса дополнительно задаются границы длительности
+ * функцией gtk_cifro_scope_set_trigger_pulse(), для синхронизации по окну - границы окна
+ * функцией gtk_cifro_scope_set_trigger_window(). Тип %GTK_CIFRO_SCOPE_TRIGGER_NONE
+ * отключает синхронизацию.
+ *
+ */
+void
+gtk_cifro_scope_set_trigger (GtkCifroScope            *cscope,
+                             guint                     channel_id,
+                             GtkCifroScopeTriggerType  type,
+                             gdouble                   level,
+                             gdouble                   hysteresis)
+{
+  GtkCifroScopePrivate *priv;
+
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  priv = cscope->priv;
+
+  priv->trigger_channel = channel_id;
+  priv->trigger_type = type;
+  priv->trigger_level = level;
+  priv->trigger_hysteresis = hysteresis;
+  priv->trigger_state = GTK_CIFRO_SCOPE_TRIGGER_WAIT;
+  priv->trigger_hold = FALSE;
+
+  if (type == GTK_CIFRO_SCOPE_TRIGGER_NONE)
+    {
+      priv->trigger_state = GTK_CIFRO_SCOPE_TRIGGER_FREE_RUN;
+      gtk_cifro_scope_trigger_set_shift (priv, 0.0);
+    }
+
+  gtk_widget_queue_draw (GTK_WIDGET (cscope));
+}
+
+/**
+ * gtk_cifro_scope_set_trigger_mode:
+ * @cscope: указатель на #GtkCifroScope
+ * @mode: режим синхронизации
+ *
+ * Функция устанавливает режим синхронизации осциллографа. По умолчанию используется
+ * автоматический режим %GTK_CIFRO_SCOPE_TRIGGER_AUTO.
+ *
+ */
+void
+gtk_cifro_scope_set_trigger_mode (GtkCifroScope            *cscope,
+                                  GtkCifroScopeTriggerMode  mode)
+{
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  cscope->priv->trigger_mode = mode;
+
+  gtk_cifro_scope_trigger_arm (cscope);
+}
+
+/**
+ * gtk_cifro_scope_set_trigger_position:
+ * @cscope: указатель на #GtkCifroScope
+ * @pre_trigger: доля видимой области до точки синхронизации, от 0 до 1
+ *
+ * Функция устанавливает положение точки синхронизации в видимой области. Значение 0
+ * соответствует левой границе видимой области, 1 - правой. По умолчанию точка
+ * синхронизации располагается в центре видимой области.
+ *
+ */
+void
+gtk_cifro_scope_set_trigger_position (GtkCifroScope *cscope,
+                                      gdouble        pre_trigger)
+{
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  cscope->priv->trigger_position = CLAMP (pre_trigger, 0.0, 1.0);
+}
+
+/**
+ * gtk_cifro_scope_set_trigger_pulse:
+ * @cscope: указатель на #GtkCifroScope
+ * @min_width: минимальная длительность импульса в отсчётах
+ * @max_width: максимальная длительность импульса в отсчётах или 0
+ *
+ * Функция устанавливает границы длительности импульса для синхронизации типов
+ * %GTK_CIFRO_SCOPE_TRIGGER_PULSE_HIGH и %GTK_CIFRO_SCOPE_TRIGGER_PULSE_LOW. Если
+ * @max_width равно 0, длительность импульса сверху не ограничивается.
+ *
+ */
+void
+gtk_cifro_scope_set_trigger_pulse (GtkCifroScope *cscope,
+                                   guint          min_width,
+                                   guint          max_width)
+{
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  cscope->priv->trigger_min_width = min_width;
+  cscope->priv->trigger_max_width = max_width;
+}
+
+/**
+ * gtk_cifro_scope_set_trigger_window:
+ * @cscope: указатель на #GtkCifroScope
+ * @low: нижняя граница окна
+ * @high: верхняя граница окна
+ *
+ * Функция устанавливает границы окна для синхронизации типа %GTK_CIFRO_SCOPE_TRIGGER_WINDOW.
+ * Синхронизация срабатывает при выходе сигнала за границы окна.
+ *
+ */
+void
+gtk_cifro_scope_set_trigger_window (GtkCifroScope *cscope,
+                                    gdouble        low,
+                                    gdouble        high)
+{
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  cscope->priv->trigger_low = MIN (low, high);
+  cscope->priv->trigger_high = MAX (low, high);
+}
+
+/**
+ * gtk_cifro_scope_trigger_arm:
+ * @cscope: указатель на #GtkCifroScope
+ *
+ * Функция взводит синхронизацию повторно. В однократном режиме после этого будут
+ * отображены данные следующего события синхронизации.
+ *
+ */
+void
+gtk_cifro_scope_trigger_arm (GtkCifroScope *cscope)
+{
+  g_return_if_fail (GTK_IS_CIFRO_SCOPE (cscope));
+
+  if (cscope->priv->trigger_type == GTK_CIFRO_SCOPE_TRIGGER_NONE)
+    return;
+
+  cscope->priv->trigger_state = GTK_CIFRO_SCOPE_TRIGGER_WAIT;
+  cscope->priv->trigger_hold = FALSE;
+}
+
+/**
+ * gtk_cifro_scope_get_trigger_state:
+ * @cscope: указатель на #GtkCifroScope
+ *
+ * Функция возвращает текущее состояние синхронизации осциллографа.
+ *
+ * Returns: Состояние синхронизации.
+ *
+ */
+GtkCifroScopeTriggerState
+gtk_cifro_scope_get_trigger_state (GtkCifroScope *cscope)
+{
+  g_return_val_if_fail (GTK_IS_CIFRO_SCOPE (cscope), GTK_CIFRO_SCOPE_TRIGGER_FREE_RUN);
+
+  return cscope->priv->trigger_state;
+}
+
+/**
+ * gtk_cifro_scope_search_channel:
+ * @cscope: указатель на #GtkCifroScope
+ * @channel_id: идентификатор канала данных
+ * @type: тип поиска
+ * @level: уровень в единицах оси значений
+ * @width: максимальная длительность глитча в отсчётах
+ * @from: индекс значения, с которого начинается поиск
+ * @forward: %TRUE - поиск в сторону увеличения индексов, %FALSE - в сторону уменьшения
+ *
+ * Функция ищет в данных канала начало следующего (или предыдущего) участка, на котором
+ * значения больше уровня @level (%GTK_CIFRO_SCOPE_SEARCH_ABOVE), меньше уровня
+ * (%GTK_CIFRO_SCOPE_SEARCH_BELOW), или равны NaN (%GTK_CIFRO_SCOPE_SEARCH_NAN). Участок,
+ * которому принадлежит значение с индексом @from, пропускается. При поиске глитчей
+ * (%GTK_CIFRO_SCOPE_SEARCH_GLITCH) ищется участок длиной меньше @width отсчётов, на котором
+ * значения находятся по одну сторону от уровня, а до и после него - по другую.
+ *
+ * Для ускорения поиска по данным канала строится иерархия сводных данных, в которой
+ * для каждого блока значений хранятся минимальное и максимальное значения и число NaN.
+ * Иерархия строится при первом поиске после изменения данных.
+ *
+ * Найденный индекс можно перевести в значение по оси времени функцией
+ * gtk_cifro_scope_get_channel_time().
+ *
+ * Returns: Индекс найденного значения или -1, если значение не найдено.
+ *
+ */
+gint64
+gtk_cifro_scope_search_channel (GtkCifroScope           *cscope,
+                                guint                    channel_id,
+                                GtkCifroScopeSearchType  type,
+                                gdouble                  level,
+                                guint                    width,
+                                gint64                   from,
+                                gboolean                 forward)
+{
+  GtkCifroScopeChannel *channel;
+  gint64 high, low;
+
+  g_return_val_if_fail (GTK_IS_CIFRO_SCOPE (cscope), -1);
+
+  channel = gtk_cifro_scope_get_channel (cscope->priv, channel_id);
+  if ((channel == NULL) || (from < 0) || (from >= channel->num))
+    return -1;
+
+  switch (type)
+    {
+    case GTK_CIFRO_SCOPE_SEARCH_ABOVE:
+      return gtk_cifro_scope_search_run (channel, from, forward,
+                                         CIFRO_SCOPE_DATA_ABOVE, CIFRO_SCOPE_DATA_NOT_ABOVE, level);
+
+    case GTK_CIFRO_SCOPE_SEARCH_BELOW:
+      return gtk_cifro_scope_search_run (channel, from, forward,
+                                         CIFRO_SCOPE_DATA_BELOW, CIFRO_SCOPE_DATA_NOT_BELOW, level);
+
+    case GTK_CIFRO_SCOPE_SEARCH_NAN:
+      return gtk_cifro_scope_search_run (channel, from, forward,
+                                         CIFRO_SCOPE_DATA_NAN, CIFRO_SCOPE_DATA_NUMBER, level);
+
+    case GTK_CIFRO_SCOPE_SEARCH_GLITCH:
+      high = gtk_cifro_scope_search_glitch (channel, from, forward,
+                                            CIFRO_SCOPE_DATA_ABOVE, CIFRO_SCOPE_DATA_NOT_ABOVE, level, width);
+      low = gtk_cifro_scope_search_glitch (channel, from, forward,
+                                           CIFRO_SCOPE_DATA_NOT_ABOVE, CIFRO_SCOPE_DATA_ABOVE, level, width);
+      if ((high < 0) || (low < 0))
+        return MAX (high, low);
+      return forward ? MIN (high, low) : MAX (high, low);
+    }
+
+  return -1;
+}
+
+/**
+ * gtk_cifro_scope_get_channel_time:
+ * @cscope: указатель на #GtkCifroScope
+ * @channel_id: идентификатор канала данных
+ * @index: индекс значения
+ *
+ * Функция возвращает значение по оси времени для значения канала с указанным индексом.
+ * Результат можно передать в функцию gtk_cifro_area_set_view_center().
+ *
+ * Returns: Значение по оси времени.
+ *
+ */
+gdouble
+gtk_cifro_scope_get_channel_time (GtkCifroScope *cscope,
+                                  guint          channel_id,
+                                  gint64         index)
+{
+  GtkCifroScopeChannel *channel;
+
+  g_return_val_if_fail (GTK_IS_CIFRO_SCOPE (cscope), 0.0);
+
+  channel = gtk_cifro_scope_get_channel (cscope->priv, channel_id);
+  if (channel == NULL)
+    return 0.0;
+
+  return (index * channel->time_step) + channel->time_shift;
+}
+
+/**
+ * gtk_cifro_scope_get_channel_stats:
+ * @cscope: указатель на #GtkCifroScope
+ * @channel_id: идентификатор канала данных
+ * @visible_only: %TRUE - статистика по видимой области, %FALSE - по всем данным канала
+ * @stats: (out): статистика данных канала
+ *
+ * Функция возвращает минимальное, максимальное, среднее и среднеквадратичное значения,
+ * размах, частоту и коэффициент заполнения данных канала. Значения NaN не учитываются.
+ *
+ * Частота и коэффициент заполнения определяются относительно уровня посередине между
+ * минимальным и максимальным значениями с гистерезисом 5% от размаха. Частота равна 0,
+ * если сигнал пересекает уровень снизу вверх меньше двух раз.
+ *
+ * Статистика вычисляется по иерархии сводных данных, используемой для поиска, за время
+ * O(log N) для минимума, максимума, среднего и среднеквадратичного значений. При подсчёте
+ * пересечений уровня просматриваются только блоки, в которых сигнал его пересекает.
+ * Результат запоминается до изменения данных канала или диапазона индексов.
+ *
+ * Returns: %TRUE - если статистика вычислена, %FALSE - если в диапазоне нет данных.
+ *
+ */
+gboolean
+gtk_cifro_scope_get_channel_stats (GtkCifroScope      *cscope,
+                                   guint               channel_id,
+                                   gboolean            visible_only,
+                                   GtkCifroScopeStats *stats)
+{
+  GtkCifroScopeChannel *channel;
+
+  g_return_val_if_fail (GTK_IS_CIFRO_SCOPE (cscope), FALSE);
+  g_return_val_if_fail (stats != NULL, FALSE);
+
+  channel = gtk_cifro_scope_get_channel (cscope->priv, channel_id);
+  if (channel == NULL)
+    return FALSE;
+
+  return gtk_cifro_scope_channel_stats (GTK_CIFRO_AREA (cscope), channel, visible_only, stats);
+}
@@ -78,6 +78,109 @@ typedef enum
   GTK_CIFRO_SCOPE_CROSSED_LINE
 } GtkCifroScopeDrawType;
 
+/**
+ * GtkCifroScopeTriggerType:
+ * @GTK_CIFRO_SCOPE_TRIGGER_NONE: Синхронизация отключена.
+ * @GTK_CIFRO_SCOPE_TRIGGER_RISING: Синхронизация по нарастающему фронту.
+ * @GTK_CIFRO_SCOPE_TRIGGER_FALLING: Синхронизация по спадающему фронту.
+ * @GTK_CIFRO_SCOPE_TRIGGER_PULSE_HIGH: Синхронизация по длительности положительного импульса.
+ * @GTK_CIFRO_SCOPE_TRIGGER_PULSE_LOW: Синхронизация по длительности отрицательного импульса.
+ * @GTK_CIFRO_SCOPE_TRIGGER_WINDOW: Синхронизация по выходу сигнала за границы окна.
+ *
+ * Типы синхронизации осциллографа.
+ *
+ */
+typedef enum
+{
+  GTK_CIFRO_SCOPE_TRIGGER_NONE,
+  GTK_CIFRO_SCOPE_TRIGGER_RISING,
+  GTK_CIFRO_SCOPE_TRIGGER_FALLING,
+  GTK_CIFRO_SCOPE_TRIGGER_PULSE_HIGH,
+  GTK_CIFRO_SCOPE_TRIGGER_PULSE_LOW,
+  GTK_CIFRO_SCOPE_TRIGGER_WINDOW
+} GtkCifroScopeTriggerType;
+
+/**
+ * GtkCifroScopeTriggerMode:
+ * @GTK_CIFRO_SCOPE_TRIGGER_AUTO: Автоматический режим, при отсутствии события синхронизации
+ *   данные отображаются без синхронизации.
+ * @GTK_CIFRO_SCOPE_TRIGGER_NORMAL: Ждущий режим, данные отображаются только при наличии
+ *   события синхронизации.
+ * @GTK_CIFRO_SCOPE_TRIGGER_SINGLE: Однократный режим, отображаются данные первого
+ *   события синхронизации, после чего они удерживаются до повторного запуска.
+ *
+ * Режимы синхронизации осциллографа.
+ *
+ */
+typedef enum
+{
+  GTK_CIFRO_SCOPE_TRIGGER_AUTO = 1,
+  GTK_CIFRO_SCOPE_TRIGGER_NORMAL,
+  GTK_CIFRO_SCOPE_TRIGGER_SINGLE
+} GtkCifroScopeTriggerMode;
+
+/**
+ * GtkCifroScopeTriggerState:
+ * @GTK_CIFRO_SCOPE_TRIGGER_WAIT: Ожидание события синхронизации.
+ * @GTK_CIFRO_SCOPE_TRIGGER_TRIGGERED: Данные синхронизированы.
+ * @GTK_CIFRO_SCOPE_TRIGGER_FREE_RUN: Данные отображаются без синхронизации.
+ * @GTK_CIFRO_SCOPE_TRIGGER_STOPPED: Данные однократного запуска удерживаются.
+ *
+ * Состояния синхронизации осциллографа.
+ *
+ */
+typedef enum
+{
+  GTK_CIFRO_SCOPE_TRIGGER_WAIT = 1,
+  GTK_CIFRO_SCOPE_TRIGGER_TRIGGERED,
+  GTK_CIFRO_SCOPE_TRIGGER_FREE_RUN,
+  GTK_CIFRO_SCOPE_TRIGGER_STOPPED
+} GtkCifroScopeTriggerState;
+
+/**
+ * GtkCifroScopeSearchType:
+ * @GTK_CIFRO_SCOPE_SEARCH_ABOVE: Поиск участка со значениями больше уровня.
+ * @GTK_CIFRO_SCOPE_SEARCH_BELOW: Поиск участка со значениями меньше уровня.
+ * @GTK_CIFRO_SCOPE_SEARCH_GLITCH: Поиск глитча - короткого участка по другую сторону от уровня.
+ * @GTK_CIFRO_SCOPE_SEARCH_NAN: Поиск участка со значениями NaN.
+ *
+ * Типы поиска в данных канала.
+ *
+ */
+typedef enum
+{
+  GTK_CIFRO_SCOPE_SEARCH_ABOVE = 1,
+  GTK_CIFRO_SCOPE_SEARCH_BELOW,
+  GTK_CIFRO_SCOPE_SEARCH_GLITCH,
+  GTK_CIFRO_SCOPE_SEARCH_NAN
+} GtkCifroScopeSearchType;
+
+/**
+ * GtkCifroScopeStats:
+ * @min: Минимальное значение.
+ * @max: Максимальное значение.
+ * @mean: Среднее значение.
+ * @rms: Среднеквадратичное значение.
+ * @peak_to_peak: Размах значений.
+ * @frequency: Частота сигнала в единицах, обратных единицам оси времени, или 0.
+ * @duty_cycle: Коэффициент заполнения - доля значений выше среднего уровня.
+ * @n_values: Число значений (без учёта NaN).
+ *
+ * Статистика данных канала в единицах оси значений.
+ *
+ */
+typedef struct
+{
+  gdouble              min;
+  gdouble              max;
+  gdouble              mean;
+  gdouble              rms;
+  gdouble              peak_to_peak;
+  gdouble              frequency;
+  gdouble              duty_cycle;
+  gint64               n_values;
+} GtkCifroScopeStats;
+
 #define GTK_TYPE_CIFRO_SCOPE             (gtk_cifro_scope_get_type ())
 #define GTK_CIFRO_SCOPE(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), GTK_TYPE_CIFRO_SCOPE, GtkCifroScope))
 #define GTK_IS_CIFRO_SCOPE(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GTK_TYPE_CIFRO_SCOPE))
@@ -125,6 +228,23 @@ GTK_CIFROAREA_EXPORT
 void                   gtk_cifro_scope_set_info_show           (GtkCifroScope         *cscope,
                                                                 gboolean               show);
 
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_info_stats          (GtkCifroScope         *cscope,
+                                                                gboolean               show,
+                                                                gboolean               visible_only);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_autoscale           (GtkCifroScope         *cscope,
+                                                                gboolean               continuous,
+                                                                gdouble                margin);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_autoscale               (GtkCifroScope         *cscope);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_render_threads      (GtkCifroScope         *cscope,
+                                                                guint                  n_threads);
+
 GTK_CIFROAREA_EXPORT
 void                   gtk_cifro_scope_set_axis_name           (GtkCifroScope         *cscope,
                                                                 const gchar           *time_axis_name,
@@ -166,6 +286,21 @@ void                   gtk_cifro_scope_set_channel_color       (GtkCifroScope
                                                                 gdouble                green,
                                                                 gdouble                blue);
 
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_channel_antialias   (GtkCifroScope         *cscope,
+                                                                guint                  channel_id,
+                                                                gboolean               antialias);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_channel_line_width  (GtkCifroScope         *cscope,
+                                                                guint                  channel_id,
+                                                                gdouble                line_width);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_channel_opacity     (GtkCifroScope         *cscope,
+                                                                guint                  channel_id,
+                                                                gdouble                opacity);
+
 GTK_CIFROAREA_EXPORT
 void                   gtk_cifro_scope_set_channel_data        (GtkCifroScope         *cscope,
                                                                 guint                  channel_id,
@@ -177,6 +312,62 @@ void                   gtk_cifro_scope_set_channel_show        (GtkCifroScope
                                                                 guint                  channel_id,
                                                                 gboolean               show);
 
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_channel_z_order     (GtkCifroScope         *cscope,
+                                                                guint                  channel_id,
+                                                                gint                   z_order);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_trigger             (GtkCifroScope         *cscope,
+                                                                guint                  channel_id,
+                                                                GtkCifroScopeTriggerType type,
+                                                                gdouble                level,
+                                                                gdouble                hysteresis);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_trigger_mode        (GtkCifroScope         *cscope,
+                                                                GtkCifroScopeTriggerMode mode);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_trigger_position    (GtkCifroScope         *cscope,
+                                                                gdouble                pre_trigger);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_trigger_pulse       (GtkCifroScope         *cscope,
+                                                                guint                  min_width,
+                                                                guint                  max_width);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_set_trigger_window      (GtkCifroScope         *cscope,
+                                                                gdouble                low,
+                                                                gdouble                high);
+
+GTK_CIFROAREA_EXPORT
+void                   gtk_cifro_scope_trigger_arm             (GtkCifroScope         *cscope);
+
+GTK_CIFROAREA_EXPORT
+GtkCifroScopeTriggerState gtk_cifro_scope_get_trigger_state    (GtkCifroScope         *cscope);
+
+GTK_CIFROAREA_EXPORT
+gint64                 gtk_cifro_scope_search_channel          (GtkCifroScope         *cscope,
+                                                                guint                  channel_id,
+                                                                GtkCifroScopeSearchType type,
+                                                                gdouble                level,
+                                                                guint                  width,
+                                                                gint64                 from,
+                                                                gboolean               forward);
+
+GTK_CIFROAREA_EXPORT
+gdouble                gtk_cifro_scope_get_channel_time        (GtkCifroScope         *cscope,
+                                                                guint                  channel_id,
+                                                                gint64                 index);
+
+GTK_CIFROAREA_EXPORT
+gboolean               gtk_cifro_scope_get_channel_stats       (GtkCifroScope         *cscope,
+                                                                guint                  channel_id,
+                                                                gboolean               visible_only,
+                                                                GtkCifroScopeStats    *stats);
+
 G_END_DECLS
 
 #endif /* __GTK_CIFRO_SCOPE_H__ */
@@ -0,0 +1,502 @@
+/*
+ * GtkCifroArea - 2D layers image management library.
+ *
+ * Copyright 2013-2017 Andrei Fadeev (andrei@webcontrol.ru)
+ *
+ * This file is part of GtkCifroArea.
+ *
+ * GtkCifroArea is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GtkCifroArea is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the author in this case.
+ *
+*/
+
+/*
+ * Программа измерения скорости формирования изображения осциллографом и редактором
+ * кривых. Изображения формируются вне экрана функцией gtk_cifro_area_render, поэтому
+ * окна не создаются, но GTK должна быть инициализирована. Результаты выводятся в
+ * формате CSV или JSON.
+ *
+ */
+
+#include <gtk-cifro-curve.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Тип тестируемого виджета. */
+typedef enum
+{
+  BENCH_WIDGET_SCOPE,
+  BENCH_WIDGET_CURVE,
+  BENCH_WIDGET_AREA
+} BenchWidgetType;
+
+/* Сценарий измерений. */
+typedef struct
+{
+  gchar                 *name;                 /* Название сценария. */
+  BenchWidgetType        widget;               /* Тип виджета. */
+  GtkCifroScopeDrawType  draw_type;            /* Тип осциллограмм. */
+  GtkCifroScopeGravity   gravity;              /* Направление осей. */
+  guint                  n_channels;           /* Число каналов. */
+  guint                  n_points;             /* Число точек в канале. */
+  gdouble                angle;                /* Угол поворота изображения. */
+  gboolean               cursor;               /* Перемещение курсора на каждом кадре. */
+  gboolean               cached;               /* Повторное формирование неизменного кадра. */
+} BenchScenario;
+
+/* Результаты измерений. */
+typedef struct
+{
+  gdouble                ns_mean;              /* Среднее время формирования кадра, нс. */
+  gdouble                ns_median;            /* Медиана времени формирования кадра, нс. */
+  gdouble                ns_min;               /* Минимальное время формирования кадра, нс. */
+  gdouble                samples_per_second;   /* Число просмотренных значений в секунду. */
+  gdouble                pixels_per_second;    /* Число изменённых точек изображения в секунду. */
+} BenchResult;
+
+static guint           width = 1024;                   /* Ширина изображения. */
+static guint           height = 768;                   /* Высота изображения. */
+static guint           n_frames = 20;                  /* Число кадров в каждом сценарии. */
+static gdouble         max_samples = 1e8;              /* Максимальное число значений во всех каналах. */
+static gchar          *format = "csv";                 /* Формат вывода результатов. */
+static gchar          *filter = NULL;                  /* Подстрока в названии выполняемых сценариев. */
+static gchar          *output = NULL;                  /* Файл для вывода результатов. */
+
+static gfloat         *data = NULL;                    /* Данные для всех каналов. */
+static guint           n_data = 0;                     /* Число значений в data. */
+
+/* Названия типов осциллограмм. */
+static const gchar *draw_type_names[] =
+{
+  NULL,
+  "lined",
+  "dotted",
+  "dotted2",
+  "dotted-line",
+  "crossed",
+  "crossed-line"
+};
+
+/* Названия направлений осей. */
+static const gchar *gravity_names[] =
+{
+  NULL,
+  "right-up",
+  "left-up",
+  "right-down",
+  "left-down",
+  "up-right",
+  "up-left",
+  "down-right",
+  "down-left"
+};
+
+/* Функция кусочно-линейной интерполяции для редактора кривых. */
+static gdouble
+curve_func_linear (gdouble   param,
+                   GArray   *points,
+                   gpointer  curve_data)
+{
+  GtkCifroCurvePoint *point;
+  GtkCifroCurvePoint *point2;
+  guint i;
+
+  if (points->len < 2)
+    return param;
+
+  for (i = 1; i < points->len - 1; i++)
+    if (g_array_index (points, GtkCifroCurvePoint, i).x >= param)
+      break;
+
+  point = &g_array_index (points, GtkCifroCurvePoint, i - 1);
+  point2 = &g_array_index (points, GtkCifroCurvePoint, i);
+
+  return point->y + (param - point->x) * (point2->y - point->y) / (point2->x - point->x);
+}
+
+/* Функция рисования в видимой области для сценариев с GtkCifroArea. */
+static void
+area_visible_draw (GtkWidget *widget,
+                   cairo_t   *cairo,
+                   gpointer   user_data)
+{
+  GtkCifroArea *carea = GTK_CIFRO_AREA (widget);
+  BenchScenario *scenario = user_data;
+  gdouble x, y;
+  guint i;
+
+  cairo_set_line_width (cairo, 1.0);
+  cairo_set_source_rgb (cairo, 0.0, 0.6, 0.0);
+
+  for (i = 0; i < scenario->n_points; i++)
+    {
+      gtk_cifro_area_visible_value_to_point (carea, &x, &y, i, data[i]);
+      if (i == 0)
+        cairo_move_to (cairo, x, y);
+      else
+        cairo_line_to (cairo, x, y);
+    }
+
+  cairo_stroke (cairo);
+
+  /* Число изменённых точек при рисовании через cairo неизвестно. */
+  gtk_cifro_area_add_render_stats (carea, scenario->n_points, scenario->n_points - 1, 0);
+}
+
+/* Функция формирует воспроизводимые данные: синусоида с шумом. */
+static void
+bench_prepare_data (guint n_points)
+{
+  GRand *rand;
+  guint i;
+
+  if (n_points <= n_data)
+    return;
+
+  g_free (data);
+  data = g_new (gfloat, n_points);
+  n_data = n_points;
+
+  rand = g_rand_new_with_seed (1);
+  for (i = 0; i < n_points; i++)
+    data[i] = 0.8 * sin (2.0 * G_PI * 16.0 * i / n_points) + g_rand_double_range (rand, -0.2, 0.2);
+  g_rand_free (rand);
+}
+
+/* Функция добавляет сценарий в список. */
+static void
+bench_add_scenario (GArray                *scenarios,
+                    BenchWidgetType        widget,
+                    GtkCifroScopeDrawType  draw_type,
+                    GtkCifroScopeGravity   gravity,
+                    guint                  n_channels,
+                    guint                  n_points,
+                    gdouble                angle,
+                    gboolean               cursor,
+                    gboolean               cached)
+{
+  BenchScenario scenario;
+
+  if ((gdouble) n_channels * n_points > max_samples)
+    return;
+
+  scenario.widget = widget;
+  scenario.draw_type = draw_type;
+  scenario.gravity = gravity;
+  scenario.n_channels = n_channels;
+  scenario.n_points = n_points;
+  scenario.angle = angle;
+  scenario.cursor = cursor;
+  scenario.cached = cached;
+
+  if (widget == BENCH_WIDGET_AREA)
+    scenario.name = g_strdup_printf ("area-rotated-p%u", n_points);
+  else
+    scenario.name = g_strdup_printf ("%s-%s-%s-c%u-p%u%s%s",
+                                     (widget == BENCH_WIDGET_SCOPE) ? "scope" : "curve",
+                                     draw_type_names[draw_type], gravity_names[gravity],
+                                     n_channels, n_points, cursor ? "-cursor" : "",
+                                     cached ? "-cached" : "");
+
+  if ((filter != NULL) && (strstr (scenario.name, filter) == NULL))
+    {
+      g_free (scenario.name);
+      return;
+    }
+
+  g_array_append_val (scenarios, scenario);
+}
+
+/* Функция создаёт виджет сценария. */
+static GtkWidget *
+bench_create_widget (BenchScenario *scenario)
+{
+  GtkWidget *widget;
+  guint channel_id;
+  guint i;
+
+  if (scenario->widget == BENCH_WIDGET_AREA)
+    {
+      widget = gtk_cifro_area_new ();
+      g_signal_connect (widget, "visible-draw", G_CALLBACK (area_visible_draw), scenario);
+      gtk_cifro_area_set_angle (GTK_CIFRO_AREA (widget), scenario->angle);
+      gtk_cifro_area_set_view (GTK_CIFRO_AREA (widget), 0.0, scenario->n_points, -1.0, 1.0);
+
+      return widget;
+    }
+
+  if (scenario->widget == BENCH_WIDGET_CURVE)
+    {
+      widget = gtk_cifro_curve_new (scenario->gravity, curve_func_linear, NULL);
+      for (i = 0; i < 16; i++)
+        gtk_cifro_curve_add_point (GTK_CIFRO_CURVE (widget),
+                                   (gdouble) i * scenario->n_points / 15.0, (i % 2) ? 0.5 : -0.5);
+    }
+  else
+    {
+      widget = gtk_cifro_scope_new (scenario->gravity);
+    }
+
+  for (i = 0; i < scenario->n_channels; i++)
+    {
+      channel_id = gtk_cifro_scope_add_channel (GTK_CIFRO_SCOPE (widget));
+      gtk_cifro_scope_set_channel_draw_type (GTK_CIFRO_SCOPE (widget), channel_id, scenario->draw_type);
+      gtk_cifro_scope_set_channel_color (GTK_CIFRO_SCOPE (widget), channel_id,
+                                         (i % 3) == 0, (i % 3) == 1, (i % 3) == 2);
+      gtk_cifro_scope_set_channel_value_param (GTK_CIFRO_SCOPE (widget), channel_id,
+                                               0.0, 1.0 - 0.5 * i / scenario->n_channels);
+      gtk_cifro_scope_set_channel_data (GTK_CIFRO_SCOPE (widget), channel_id, scenario->n_points, data);
+    }
+
+  gtk_cifro_scope_set_channel_time_param (GTK_CIFRO_SCOPE (widget), 0, 0.0, 1.0);
+  gtk_cifro_scope_set_limits (GTK_CIFRO_SCOPE (widget), 0.0, scenario->n_points, -1.1, 1.1);
+  gtk_cifro_scope_set_info_show (GTK_CIFRO_SCOPE (widget), scenario->cursor);
+  gtk_cifro_area_set_view (GTK_CIFRO_AREA (widget), 0.0, scenario->n_points, -1.1, 1.1);
+
+  return widget;
+}
+
+/* Функция сравнения времени формирования кадров. */
+static gint
+bench_compare_time (gconstpointer a,
+                    gconstpointer b)
+{
+  gdouble time1 = *(const gdouble*) a;
+  gdouble time2 = *(const gdouble*) b;
+
+  return (time1 > time2) - (time1 < time2);
+}
+
+/* Функция выполняет измерения для одного сценария. */
+static gboolean
+bench_run_scenario (BenchScenario *scenario,
+                    BenchResult   *result)
+{
+  GtkCifroAreaRenderStats stats;
+  cairo_surface_t *surface;
+  GtkWidget *widget;
+  GdkEvent *event;
+  GTimer *timer;
+  gdouble *times;
+  gdouble total = 0.0;
+  gdouble samples = 0.0;
+  gdouble pixels = 0.0;
+  gdouble from_x, to_x;
+  gdouble from_y, to_y;
+  gdouble shift;
+  gboolean handled;
+  gboolean status;
+  guint i;
+
+  bench_prepare_data (scenario->n_points);
+
+  widget = bench_create_widget (scenario);
+  g_object_ref_sink (widget);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  times = g_new (gdouble, n_frames);
+  timer = g_timer_new ();
+
+  event = gdk_event_new (GDK_MOTION_NOTIFY);
+  event->motion.send_event = TRUE;
+  event->motion.y = height / 2.0;
+
+  /* Первый кадр не учитывается: в нём создаются буферы и шрифты. */
+  status = gtk_cifro_area_render (GTK_CIFRO_AREA (widget), surface, width, height);
+  gtk_cifro_area_get_view (GTK_CIFRO_AREA (widget), &from_x, &to_x, &from_y, &to_y);
+
+  for (i = 0; (i < n_frames) && status; i++)
+    {
+      g_timer_start (timer);
+
+      if (scenario->cursor)
+        {
+          event->motion.x = width * (0.1 + 0.8 * i / n_frames);
+          g_signal_emit_by_name (widget, "motion-notify-event", event, &handled);
+        }
+
+      /* Без изменения границ отображения каждый кадр воспроизводился бы из кэша команд
+         рисования и данные не просматривались бы. Границы по оси Y сужаются на долю
+         точки изображения поочерёдно на разную величину: кэш становится недействительным,
+         а изображение заметно не изменяется и не выходит за пределы перемещения. */
+      if (scenario->cached)
+        {
+          status = gtk_cifro_area_render (GTK_CIFRO_AREA (widget), surface, width, height);
+        }
+      else
+        {
+          shift = 0.125 * ((i % 2) + 1) * (to_y - from_y) / height;
+          status = gtk_cifro_area_render_view (GTK_CIFRO_AREA (widget), surface, width, height,
+                                               from_x, to_x, from_y + shift, to_y - shift);
+        }
+
+      times[i] = 1e9 * g_timer_elapsed (timer, NULL);
+      total += times[i];
+
+      gtk_cifro_area_get_render_stats (GTK_CIFRO_AREA (widget), &stats);
+      samples += stats.samples;
+      pixels += stats.pixels;
+    }
+
+  if (status)
+    {
+      qsort (times, n_frames, sizeof (gdouble), bench_compare_time);
+
+      result->ns_mean = total / n_frames;
+      result->ns_median = times[n_frames / 2];
+      result->ns_min = times[0];
+      result->samples_per_second = 1e9 * samples / total;
+      result->pixels_per_second = 1e9 * pixels / total;
+    }
+
+  gdk_event_free (event);
+  g_timer_destroy (timer);
+  g_free (times);
+  cairo_surface_destroy (surface);
+  gtk_widget_destroy (widget);
+  g_object_unref (widget);
+
+  return status;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  GArray *scenarios;
+  GString *report;
+  guint n_results = 0;
+  gboolean json;
+  guint i, j, k;
+
+  guint draw_types[] = { GTK_CIFRO_SCOPE_LINED, GTK_CIFRO_SCOPE_DOTTED, GTK_CIFRO_SCOPE_CROSSED };
+  guint channels[] = { 1, 8, 64 };
+  guint points[] = { 1000, 100000, 10000000, 100000000 };
+
+  /* Разбор командной строки. */
+  {
+    GError *error = NULL;
+    GOptionContext *context;
+    GOptionEntry entries[] =
+      {
+        { "width", 'W', 0, G_OPTION_ARG_INT, &width, "Image width", NULL },
+        { "height", 'H', 0, G_OPTION_ARG_INT, &height, "Image height", NULL },
+        { "frames", 'n', 0, G_OPTION_ARG_INT, &n_frames, "Number of frames per scenario", NULL },
+        { "max-samples", 's', 0, G_OPTION_ARG_DOUBLE, &max_samples, "Maximum number of samples in all channels", NULL },
+        { "filter", 'f', 0, G_OPTION_ARG_STRING, &filter, "Run only scenarios containing this substring", NULL },
+        { "format", 'o', 0, G_OPTION_ARG_STRING, &format, "Output format (csv, json)", NULL },
+        { "output", 0, 0, G_OPTION_ARG_FILENAME, &output, "Output file name", NULL },
+        { NULL }
+      };
+
+    context = g_option_context_new ("");
+    g_option_context_set_help_enabled (context, TRUE);
+    g_option_context_add_main_entries (context, entries, NULL);
+    g_option_context_set_ignore_unknown_options (context, FALSE);
+
+    if (!g_option_context_parse (context, &argc, &argv, &error))
+      {
+        g_printerr ("%s\n", error->message);
+        return -1;
+      }
+
+    g_option_context_free (context);
+  }
+
+  if (!gtk_init_check (&argc, &argv))
+    {
+      g_printerr ("can't initialize GTK\n");
+      return -1;
+    }
+
+  width = MAX (width, 64);
+  height = MAX (height, 64);
+  n_frames = MAX (n_frames, 1);
+  json = (g_strcmp0 (format, "json") == 0);
+
+  /* Список сценариев. */
+  scenarios = g_array_new (FALSE, FALSE, sizeof (BenchScenario));
+
+  for (i = 0; i < G_N_ELEMENTS (draw_types); i++)
+    for (j = 0; j < G_N_ELEMENTS (channels); j++)
+      for (k = 0; k < G_N_ELEMENTS (points); k++)
+        bench_add_scenario (scenarios, BENCH_WIDGET_SCOPE, draw_types[i], GTK_CIFRO_SCOPE_GRAVITY_RIGHT_UP,
+                            channels[j], points[k], 0.0, FALSE, FALSE);
+
+  for (i = GTK_CIFRO_SCOPE_GRAVITY_LEFT_UP; i <= GTK_CIFRO_SCOPE_GRAVITY_DOWN_LEFT; i++)
+    bench_add_scenario (scenarios, BENCH_WIDGET_SCOPE, GTK_CIFRO_SCOPE_LINED, i, 8, 100000, 0.0, FALSE, FALSE);
+
+  bench_add_scenario (scenarios, BENCH_WIDGET_SCOPE, GTK_CIFRO_SCOPE_LINED,
+                      GTK_CIFRO_SCOPE_GRAVITY_RIGHT_UP, 8, 100000, 0.0, TRUE, FALSE);
+  for (k = 0; k < G_N_ELEMENTS (points); k++)
+    bench_add_scenario (scenarios, BENCH_WIDGET_SCOPE, GTK_CIFRO_SCOPE_LINED, GTK_CIFRO_SCOPE_GRAVITY_RIGHT_UP,
+                        8, points[k], 0.0, FALSE, TRUE);
+
+  bench_add_scenario (scenarios, BENCH_WIDGET_CURVE, GTK_CIFRO_SCOPE_LINED,
+                      GTK_CIFRO_SCOPE_GRAVITY_RIGHT_UP, 8, 100000, 0.0, TRUE, FALSE);
+  bench_add_scenario (scenarios, BENCH_WIDGET_AREA, GTK_CIFRO_SCOPE_LINED,
+                      GTK_CIFRO_SCOPE_GRAVITY_RIGHT_UP, 1, 100000, G_PI / 6.0, FALSE, FALSE);
+
+  /* Измерения. */
+  report = g_string_new (NULL);
+  if (json)
+    g_string_append_printf (report, "{\n  \"width\": %u,\n  \"height\": %u,\n  \"frames\": %u,\n  \"results\": [",
+                            width, height, n_frames);
+  else
+    g_string_append (report, "scenario,channels,points,width,height,frames,"
+                             "ns_per_frame,ns_median,ns_min,samples_per_second,pixels_per_second\n");
+
+  for (i = 0; i < scenarios->len; i++)
+    {
+      BenchScenario *scenario = &g_array_index (scenarios, BenchScenario, i);
+      BenchResult result;
+
+      if (!bench_run_scenario (scenario, &result))
+        {
+          g_printerr ("%s: image size is too small\n", scenario->name);
+        }
+      else if (json)
+        g_string_append_printf (report, "%s\n    { \"scenario\": \"%s\", \"channels\": %u, \"points\": %u, "
+                                "\"ns_per_frame\": %.0f, \"ns_median\": %.0f, \"ns_min\": %.0f, "
+                                "\"samples_per_second\": %.0f, \"pixels_per_second\": %.0f }",
+                                (n_results > 0) ? "," : "", scenario->name, scenario->n_channels, scenario->n_points,
+                                result.ns_mean, result.ns_median, result.ns_min,
+                                result.samples_per_second, result.pixels_per_second);
+      else
+        g_string_append_printf (report, "%s,%u,%u,%u,%u,%u,%.0f,%.0f,%.0f,%.0f,%.0f\n",
+                                scenario->name, scenario->n_channels, scenario->n_points, width, height, n_frames,
+                                result.ns_mean, result.ns_median, result.ns_min,
+                                result.samples_per_second, result.pixels_per_second);
+
+      n_results += 1;
+      g_free (scenario->name);
+    }
+
+  if (json)
+    g_string_append (report, "\n  ]\n}\n");
+
+  if (output != NULL)
+    g_file_set_contents (output, report->str, report->len, NULL);
+  else
+    g_print ("%s", report->str);
+
+  g_string_free (report, TRUE);
+  g_array_unref (scenarios);
+  g_free (data);
+
+  return 0;
+}
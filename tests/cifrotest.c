@@ -37,6 +37,10 @@ static guint           n_points = 1000;                /* Число точек
 static gdouble         frequency = 10.0;               /* Частота сигнала, Гц. */
 static gdouble         max_time = 1000.0;              /* Максимальное время отображения, мс. */
 static gdouble         max_range = 1.0;                /* Максимальный размах амплитуды, В. */
+static gboolean        show_stats = FALSE;             /* Показывать статистику формирования изображения. */
+static gboolean        downscale = FALSE;              /* Уменьшать разрешение при взаимодействии. */
+static gboolean        zoom_preview = FALSE;           /* Показывать предварительное изображение при масштабировании. */
+static gboolean        animation = FALSE;              /* Анимация изменения вида. */
 
 static guint           channels[MAX_N_CHANNELS];
 static gfloat         *data[MAX_N_CHANNELS];
@@ -250,6 +254,10 @@ main (int    argc,
         { "points", 'n', 0, G_OPTION_ARG_INT, &n_points, "Number of points per channel", NULL },
         { "time", 't', 0, G_OPTION_ARG_DOUBLE, &max_time, "Maximum sampling time, ms", NULL },
         { "range", 'r', 0, G_OPTION_ARG_DOUBLE, &max_range, "Maximum signal range, V", NULL },
+        { "stats", 's', 0, G_OPTION_ARG_NONE, &show_stats, "Show render statistics overlay", NULL },
+        { "downscale", 'l', 0, G_OPTION_ARG_NONE, &downscale, "Render at half resolution while panning or zooming", NULL },
+        { "zoom-preview", 'z', 0, G_OPTION_ARG_NONE, &zoom_preview, "Show scaled previous frame while zooming", NULL },
+        { "animation", 'k', 0, G_OPTION_ARG_NONE, &animation, "Animate keyboard moves and continue dragging by inertia", NULL },
         { NULL }
       };
 
@@ -332,6 +340,10 @@ main (int    argc,
   gtk_cifro_scope_set_axis_name (GTK_CIFRO_SCOPE (area), "ms", "V");
   gtk_cifro_scope_set_channel_time_param (GTK_CIFRO_SCOPE (area), 0, 0.0, max_time / (n_points - 1));
   gtk_cifro_scope_set_info_show (GTK_CIFRO_SCOPE (area), TRUE);
+  gtk_cifro_area_set_stats_overlay (GTK_CIFRO_AREA (area), show_stats);
+  gtk_cifro_area_set_interaction_downscale (GTK_CIFRO_AREA (area), downscale);
+  gtk_cifro_area_set_zoom_preview (GTK_CIFRO_AREA (area), zoom_preview);
+  gtk_cifro_area_control_set_animation (GTK_CIFRO_AREA_CONTROL (area), animation);
 
   if (g_strcmp0 (draw_type, "dotted") == 0)
     gtk_cifro_scope_set_channel_draw_type (GTK_CIFRO_SCOPE (area), 0, GTK_CIFRO_SCOPE_DOTTED);